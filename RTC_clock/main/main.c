@@ -1,45 +1,14 @@
 #include <stdio.h>
-#include <string.h>
+#include <stdlib.h>
+#include "nvs_flash.h"
 #include "ds3231.h"
+#include "boot_trace.h"
 
-#define SET_TIME_FROM_COMPILE 1 // Set to 1 to set the time, 0 to read the time
-/**
- * @brief Get the compile time as a ds3231_time_t structure.
- *
- * This function retrieves the compile time and converts it to a ds3231_time_t structure.
- *
- * @return ds3231_time_t The current compile time.
- */
-// Convert compiler time to ds3231_time_t
-ds3231_time_t get_compile_time(void)
-{
-    ds3231_time_t t;
-
-    // Parse time string: "15:47:10"
-    int hour, min, sec;
-    sscanf(__TIME__, "%d:%d:%d", &hour, &min, &sec);
-    t.hour = hour;
-    t.minute = min;
-    t.second = sec;
-
-    // Parse date string: "Jul 20 2025"
-    int day, year;
-    char month_str[4];
-    sscanf(__DATE__, "%3s %d %d", month_str, &day, &year);
-
-    t.date = day;
-    t.year = year;
+#define SET_TIME_FROM_COMPILE 1 // 1 = provision the RTC from the build time (once per build)
 
-    // Convert month string to number
-    const char *months = "JanFebMarAprMayJunJulAugSepOctNovDec";
-    char *p = strstr(months, month_str);
-    t.month = (p) ? ((p - months) / 3 + 1) : 1;
+// Build timestamp, folded to constants by the compiler (weekday included)
+static const ds3231_time_t s_build_time = DS3231_BUILD_TIME_INIT;
 
-    // Day of week is unknown, just set to 1 (Sunday)
-    t.day_of_week = 1;
-
-    return t;
-}
 static inline void to_12h(uint8_t h24, uint8_t *h12, const char **ampm)
 {
     *ampm = (h24 >= 12) ? "PM" : "AM";
@@ -54,19 +23,38 @@ void app_main(void)
     i2c_bus_scan();
 
 #if SET_TIME_FROM_COMPILE
-    ds3231_time_t t = get_compile_time();
-    if (ds3231_set_time(&t) == ESP_OK)
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND)
     {
-        printf("RTC set from compile time.\n");
+        nvs_flash_erase();
+        err = nvs_flash_init();
+    }
+
+    // Writes the RTC only on the first boot of a new build, and only if it is behind
+    bool written = false;
+    if (err == ESP_OK && ds3231_provision(&s_build_time, &written) == ESP_OK)
+    {
+        printf(written ? "RTC set from compile time.\n" : "RTC already provisioned.\n");
     }
     else
     {
-        printf("RTC set failed.\n");
+        printf("RTC provisioning failed.\n");
     }
 #endif
 
+    // Seed the system clock once; time()/gettimeofday() need no I2C afterwards.
+    // The app owns TZ: localtime() then matches the RTC (and DST rules apply).
+    setenv("TZ", DS3231_TZ, 1);
+    tzset();
+    time_t epoch;
+    if (ds3231_sync_system_time(&epoch) == ESP_OK)
+    {
+        printf("System time synced: %lld\n", (long long)epoch);
+    }
+    boot_trace_dump();
+
     ds3231_time_t now;
-    while (1)
+    for (uint32_t tick = 1;; ++tick)
     {
         if (ds3231_get_time(&now) == ESP_OK)
         {
@@ -77,6 +65,17 @@ void app_main(void)
                    h12, now.minute, now.second, ampm,
                    now.month, now.date, now.year);
         }
+
+        // Driver health once a minute
+        if (tick % 60 == 0)
+        {
+            ds3231_stats_t st;
+            ds3231_get_stats(&st);
+            printf("I2C: reads=%lu errors=%lu retries=%lu failures=%lu recoveries=%lu max=%luus\n",
+                   (unsigned long)st.reads, (unsigned long)st.errors, (unsigned long)st.retries,
+                   (unsigned long)st.failures, (unsigned long)st.recoveries,
+                   (unsigned long)st.max_latency_us);
+        }
         vTaskDelay(pdMS_TO_TICKS(1000));
     }
 }
\ No newline at end of file
@@ -0,0 +1,237 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "sdkconfig.h"
+#include "ds3231_bcd.h"
+#include "max7219_frame.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#define BENCH_UNIT "ns"
+#define BENCH_MIN_SAMPLE 10000u  // ns: >= 10 us per sample
+#else
+#include "esp_cpu.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#define BENCH_UNIT "cycles"
+#define BENCH_MIN_SAMPLE 2400u   // cycles: ~10 us at 240 MHz
+#endif
+
+// ---------------- Configuration ----------------
+#define BENCH_SAMPLES  65    // 1 cold + 64 warm
+#define BENCH_MAX_CHAIN 8
+#define BENCH_MAX_ITERS 65536
+
+/*
+ * Output, one line per case (stable format, diff it across commits):
+ *   BENCH <name> unit=<cycles|ns> calls=<n> iters=<N> cold=<x> min=<x> median=<x> mean=<x>
+ * Values are per helper call with two decimals. "cold" is the first single
+ * fn() run (caches/branch predictors not yet trained). Each warm sample runs
+ * fn() N times, N being the smallest power of two that makes a sample at
+ * least BENCH_MIN_SAMPLE long, so single-call cases stay above timer
+ * resolution; the empty-call loop of the same length is subtracted.
+ */
+
+static inline uint32_t bench_now(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+#else
+    return (uint32_t)esp_cpu_get_cycle_count();
+#endif
+}
+
+typedef struct {
+    const char* name;
+    void      (*fn)(void);
+    uint32_t    calls;      // helper calls per fn() invocation
+} bench_case_t;
+
+static volatile uint32_t s_sink;   // keeps results observable
+
+// Frames land in a plain buffer: force every build to be stored, not just the last
+#define BENCH_CLOBBER() __asm__ volatile("" ::: "memory")
+
+// ---------------- Inputs ----------------
+static uint8_t  s_dec[100];        // 0..99
+static uint8_t  s_bcd[100];        // 0x00..0x99
+static uint32_t s_numbers[64];     // mixed magnitudes for set_number
+static uint8_t  s_tx[2 * BENCH_MAX_CHAIN];
+
+static void bench_inputs(void)
+{
+    for (int i = 0; i < 100; ++i) {
+        s_dec[i] = (uint8_t)i;
+        s_bcd[i] = (uint8_t)(((i / 10) << 4) | (i % 10));
+    }
+    uint32_t x = 2463534242u;                       // xorshift, fixed seed
+    for (int i = 0; i < 64; ++i) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        static const uint32_t mod[] = { 10, 100, 10000, 100000000 };
+        s_numbers[i] = x % mod[i & 3];
+    }
+}
+
+// ---------------- Cases ----------------
+static void case_empty(void) { s_sink++; }
+
+static void case_bcd_to_decimal(void)
+{
+    uint32_t acc = 0;
+    for (int i = 0; i < 100; ++i) acc += bcd_to_decimal(s_bcd[i]);
+    s_sink += acc;
+}
+
+static void case_decimal_to_bcd(void)
+{
+    uint32_t acc = 0;
+    for (int i = 0; i < 100; ++i) acc += decimal_to_bcd(s_dec[i]);
+    s_sink += acc;
+}
+
+// One full RTC register block (7 bytes), as in ds3231_get_time/set_time
+static void case_bcd_block7(void)
+{
+    uint32_t acc = 0;
+    for (int i = 0; i < 98; i += 7) {
+        for (int j = 0; j < 7; ++j) acc += bcd_to_decimal(s_bcd[i + j]);
+    }
+    s_sink += acc;
+}
+
+static void frame_one_chain(int n)
+{
+    for (int dev = 0; dev < n; ++dev) {
+        max7219_frame_one(s_tx, n, dev, 0x01, s_dec[dev]);
+        BENCH_CLOBBER();
+    }
+    s_sink += s_tx[0];
+}
+static void case_frame_one_chain1(void) { frame_one_chain(1); }
+static void case_frame_one_chain4(void) { frame_one_chain(4); }
+static void case_frame_one_chain8(void) { frame_one_chain(8); }
+
+static void case_frame_all_chain8(void)
+{
+    max7219_frame_all(s_tx, 8, 0x0A, s_dec[2]);
+    BENCH_CLOBBER();
+    s_sink += s_tx[0];
+}
+
+static void split_digits(uint8_t digits)
+{
+    uint8_t buf[8];
+    uint32_t acc = 0;
+    for (int i = 0; i < 64; ++i) {
+        max7219_split_digits(s_numbers[i], digits, buf);
+        acc += buf[digits - 1];
+    }
+    s_sink += acc;
+}
+static void case_split_digits4(void) { split_digits(4); }
+static void case_split_digits8(void) { split_digits(8); }
+
+static const bench_case_t s_cases[] = {
+    { "bcd_to_decimal",     case_bcd_to_decimal,   100 },
+    { "decimal_to_bcd",     case_decimal_to_bcd,   100 },
+    { "bcd_block7",         case_bcd_block7,       14  },
+    { "frame_one_chain1",   case_frame_one_chain1, 1   },
+    { "frame_one_chain4",   case_frame_one_chain4, 4   },
+    { "frame_one_chain8",   case_frame_one_chain8, 8   },
+    { "frame_all_chain8",   case_frame_all_chain8, 1   },
+    { "split_digits4",      case_split_digits4,    64  },
+    { "split_digits8",      case_split_digits8,    64  },
+};
+
+// ---------------- Harness ----------------
+static int cmp_u32(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t measure(void (*fn)(void), uint32_t iters)
+{
+    uint32_t t0 = bench_now();
+    for (uint32_t i = 0; i < iters; ++i) fn();
+    return bench_now() - t0;
+}
+
+// Timer read + loop + indirect call cost for @p iters calls, subtracted from every sample
+static uint32_t bench_overhead(uint32_t iters)
+{
+    uint32_t best = UINT32_MAX;
+    for (int i = 0; i < BENCH_SAMPLES; ++i) {
+        uint32_t t = measure(case_empty, iters);
+        if (t < best) best = t;
+    }
+    return best;
+}
+
+static uint32_t bench_iters(void (*fn)(void))
+{
+    uint32_t n = 1;
+    while (n < BENCH_MAX_ITERS && measure(fn, n) < BENCH_MIN_SAMPLE) n <<= 1;
+    return n;
+}
+
+static void print_fixed(const char* key, uint64_t total, uint64_t calls)
+{
+    uint64_t x100 = total * 100u / calls;
+    printf(" %s=%llu.%02llu", key, (unsigned long long)(x100 / 100), (unsigned long long)(x100 % 100));
+}
+
+static void bench_run(const bench_case_t* c, uint32_t overhead1)
+{
+    // Cold first, before calibration warms anything up
+    uint32_t t = measure(c->fn, 1);
+    uint32_t cold = (t > overhead1) ? t - overhead1 : 0;
+
+    uint32_t iters    = bench_iters(c->fn);
+    uint32_t overhead = bench_overhead(iters);
+    uint32_t warm[BENCH_SAMPLES - 1];
+    const int n = BENCH_SAMPLES - 1;
+    for (int i = 0; i < n; ++i) {
+        t = measure(c->fn, iters);
+        warm[i] = (t > overhead) ? t - overhead : 0;
+    }
+
+    qsort(warm, n, sizeof(uint32_t), cmp_u32);
+    uint64_t sum = 0;
+    for (int i = 0; i < n; ++i) sum += warm[i];
+
+    uint64_t per = (uint64_t)c->calls * iters;
+    printf("BENCH %-18s unit=%s calls=%lu iters=%lu", c->name, BENCH_UNIT,
+           (unsigned long)c->calls, (unsigned long)iters);
+    print_fixed("cold",   cold,        c->calls);
+    print_fixed("min",    warm[0],     per);
+    print_fixed("median", warm[n / 2], per);
+    print_fixed("mean",   sum / n,     per);
+    printf("\n");
+}
+
+static void bench_all(void)
+{
+    bench_inputs();
+    uint32_t overhead1 = bench_overhead(1);
+    printf("BENCH_BEGIN unit=%s samples=%d min_sample=%lu overhead=%lu\n", BENCH_UNIT, BENCH_SAMPLES,
+           (unsigned long)BENCH_MIN_SAMPLE, (unsigned long)overhead1);
+    for (size_t i = 0; i < sizeof(s_cases) / sizeof(s_cases[0]); ++i) {
+        bench_run(&s_cases[i], overhead1);
+    }
+    printf("BENCH_END\n");
+}
+
+void app_main(void)
+{
+#if !CONFIG_IDF_TARGET_LINUX
+    // Above everything but the IDF system tasks, to keep preemption out of the samples
+    vTaskPrioritySet(NULL, configMAX_PRIORITIES - 2);
+#endif
+    bench_all();
+#if CONFIG_IDF_TARGET_LINUX
+    exit(0);
+#endif
+}
@@ -0,0 +1,82 @@
+#include "boot_trace.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_timer.h"
+#endif
+
+typedef struct {
+    const char* name;
+    int64_t     start_us;
+    int64_t     dur_us;    // -1 while open
+    uint8_t     depth;
+} phase_t;
+
+// Boot task only, until boot_trace_dump() (see header); no locking
+static phase_t  s_phase[BOOT_TRACE_MAX_PHASES];
+static int      s_count;
+static uint8_t  s_depth;
+static uint32_t s_dropped;
+static bool     s_done;
+
+int64_t boot_trace_now_us(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+    return esp_timer_get_time();
+#endif
+}
+
+int boot_trace_begin(const char* name)
+{
+    if (s_done) return -1;
+    if (s_count >= BOOT_TRACE_MAX_PHASES) {
+        s_dropped++;
+        return -1;
+    }
+    phase_t* p  = &s_phase[s_count];
+    p->name     = name;
+    p->depth    = s_depth++;
+    p->dur_us   = -1;
+    p->start_us = boot_trace_now_us();
+    return s_count++;
+}
+
+void boot_trace_end(int id)
+{
+    if (s_done || id < 0 || id >= s_count || s_phase[id].dur_us >= 0) return;
+    s_phase[id].dur_us = boot_trace_now_us() - s_phase[id].start_us;
+    if (s_depth) s_depth--;
+}
+
+void boot_trace_mark(const char* name)
+{
+    int id = boot_trace_begin(name);
+    if (id < 0) return;
+    s_phase[id].dur_us = 0;
+    s_depth--;
+}
+
+void boot_trace_dump(void)
+{
+    if (s_done) return;
+    int64_t end_us = boot_trace_now_us();
+    s_done = true;
+
+    printf("BOOT_TRACE {\"end_us\":%lld,\"dropped\":%lu,\"phases\":[",
+           (long long)end_us, (unsigned long)s_dropped);
+    for (int i = 0; i < s_count; ++i) {
+        const phase_t* p = &s_phase[i];
+        printf("%s{\"name\":\"%s\",\"start_us\":%lld,\"dur_us\":%lld,\"depth\":%u}",
+               i ? "," : "", p->name, (long long)p->start_us,
+               (long long)(p->dur_us >= 0 ? p->dur_us : end_us - p->start_us), p->depth);
+    }
+    printf("]}\n");
+}
@@ -0,0 +1,72 @@
+/**
+ * @file boot_trace.h
+ * @brief Lightweight boot-phase tracer.
+ *
+ * Named phases are timed with esp_timer (clock_gettime on the linux target)
+ * into a fixed table; boot_trace_dump() prints one machine-readable line and
+ * ends tracing, so phases hit later (e.g. I²C recovery) cost a single branch.
+ *
+ * @code
+ * int id = BOOT_TRACE_BEGIN("i2c_init");
+ * i2c_bus_init();
+ * BOOT_TRACE_END(id);
+ * ...
+ * boot_trace_mark("first_display");
+ * boot_trace_dump();
+ * @endcode
+ *
+ * Output (single line, grep for the prefix):
+ * @code
+ * BOOT_TRACE {"end_us":412345,"dropped":0,"phases":[{"name":"i2c_init","start_us":301200,"dur_us":85,"depth":0},...]}
+ * @endcode
+ * Marks are phases with dur_us = 0.
+ *
+ * Not thread-safe: trace from the boot task only and call boot_trace_dump()
+ * before starting tasks that can reach traced code (e.g. i2c_bus_init()).
+ * After the dump every call returns at the first branch, from any task.
+ */
+
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef BOOT_TRACE_ENABLED
+#define BOOT_TRACE_ENABLED    1
+#endif
+#ifndef BOOT_TRACE_MAX_PHASES
+#define BOOT_TRACE_MAX_PHASES 32
+#endif
+
+/** @return Monotonic time in microseconds since boot. */
+int64_t boot_trace_now_us(void);
+
+/**
+ * @brief Open a phase (phases may nest).
+ * @param name String literal (stored by pointer)
+ * @return Phase id for boot_trace_end(), or -1 if the table is full or tracing ended.
+ */
+int boot_trace_begin(const char* name);
+
+/** @brief Close a phase opened by boot_trace_begin(); -1 is ignored. */
+void boot_trace_end(int id);
+
+/** @brief Record an instant milestone (e.g. "first_display"). */
+void boot_trace_mark(const char* name);
+
+/** @brief Print the summary line and stop tracing. Only the first call prints. */
+void boot_trace_dump(void);
+
+#if BOOT_TRACE_ENABLED
+#define BOOT_TRACE_BEGIN(name) boot_trace_begin(name)
+#define BOOT_TRACE_END(id)     boot_trace_end(id)
+#else
+#define BOOT_TRACE_BEGIN(name) (-1)
+#define BOOT_TRACE_END(id)     ((void)(id))
+#endif
+
+#ifdef __cplusplus
+}
+#endif
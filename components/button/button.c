@@ -0,0 +1,206 @@
+#include "button.h"
+#include <string.h>
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#if (BUTTON_QUEUE_LEN & (BUTTON_QUEUE_LEN - 1)) != 0
+#error "BUTTON_QUEUE_LEN must be a power of two"
+#endif
+
+typedef struct {
+    button_cfg_t       cfg;
+    uint8_t            id;
+    esp_timer_handle_t debounce;
+    esp_timer_handle_t gesture;       // long-press while held, double window while released
+    int64_t            debounce_due;  // scheduled expiry: last edge + debounce_ms
+    int64_t            gesture_due;
+    int64_t            release_due;   // debounced release of a pending SHORT
+    bool               pressed;       // debounced state
+    bool               long_fired;
+    bool               short_pending; // released once, waiting for a second press
+} button_t;
+
+static const char* TAG = "BUTTON";
+
+static button_t      s_btn[BUTTON_MAX];
+static uint8_t       s_count;
+static TaskHandle_t  s_consumer;
+
+// SPSC ring: producer = esp_timer task, consumer = the notified task
+static button_event_t    s_queue[BUTTON_QUEUE_LEN];
+static uint32_t          s_head;
+static uint32_t          s_tail;
+static volatile uint32_t s_dropped;
+static button_stats_t    s_stats;     // consumer side only
+
+/* ====================== Event queue ====================== */
+
+// @p due_us: scheduled expiry of the timer that decided the gesture, so the
+// latency includes esp_timer dispatch delay
+static void emit(button_t* b, button_event_type_t type, int64_t due_us)
+{
+    uint32_t head = __atomic_load_n(&s_head, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&s_tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= BUTTON_QUEUE_LEN) {
+        s_dropped++;
+        return;
+    }
+
+    button_event_t* ev = &s_queue[head & (BUTTON_QUEUE_LEN - 1)];
+    ev->id         = b->id;
+    ev->type       = type;
+    ev->stamp_us   = due_us;
+    ev->latency_us = 0;
+    __atomic_store_n(&s_head, head + 1, __ATOMIC_RELEASE);
+
+    if (s_consumer) xTaskNotifyGive(s_consumer);
+}
+
+bool button_get_event(button_event_t* ev)
+{
+    uint32_t tail = __atomic_load_n(&s_tail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&s_head, __ATOMIC_ACQUIRE);
+    if (!ev || tail == head) return false;
+
+    *ev = s_queue[tail & (BUTTON_QUEUE_LEN - 1)];
+    __atomic_store_n(&s_tail, tail + 1, __ATOMIC_RELEASE);
+
+    ev->latency_us = (uint32_t)(esp_timer_get_time() - ev->stamp_us);
+    s_stats.events++;
+    s_stats.sum_latency_us += ev->latency_us;
+    if (ev->latency_us > s_stats.max_latency_us) s_stats.max_latency_us = ev->latency_us;
+    return true;
+}
+
+void button_get_stats(button_stats_t* out)
+{
+    if (!out) return;
+    *out = s_stats;
+    out->dropped = s_dropped;
+}
+
+/* ====================== State machine ====================== */
+
+static inline bool raw_pressed(const button_t* b)
+{
+    return gpio_get_level(b->cfg.gpio) == (b->cfg.active_low ? 0 : 1);
+}
+
+static void IRAM_ATTR edge_isr(void* arg)
+{
+    button_t* b = (button_t*)arg;
+    gpio_intr_disable(b->cfg.gpio);   // mute the bounce until the level has settled
+    b->debounce_due = esp_timer_get_time() + (int64_t)b->cfg.debounce_ms * 1000;
+    esp_timer_start_once(b->debounce, (uint64_t)b->cfg.debounce_ms * 1000u);
+}
+
+static void start_gesture(button_t* b, uint16_t ms)
+{
+    b->gesture_due = esp_timer_get_time() + (int64_t)ms * 1000;
+    esp_timer_start_once(b->gesture, (uint64_t)ms * 1000u);
+}
+
+// Level stable for debounce_ms (esp_timer task)
+static void debounce_cb(void* arg)
+{
+    button_t* b = (button_t*)arg;
+    bool now = raw_pressed(b);
+
+    gpio_intr_enable(b->cfg.gpio);
+    if (raw_pressed(b) != now) {      // moved again while re-arming
+        gpio_intr_disable(b->cfg.gpio);
+        b->debounce_due = esp_timer_get_time() + (int64_t)b->cfg.debounce_ms * 1000;
+        esp_timer_start_once(b->debounce, (uint64_t)b->cfg.debounce_ms * 1000u);
+        return;
+    }
+    if (now == b->pressed) return;    // bounce only
+    b->pressed = now;
+
+    esp_timer_stop(b->gesture);
+    if (now) {
+        b->long_fired = false;
+        start_gesture(b, b->cfg.long_ms);
+        return;
+    }
+
+    if (b->long_fired) return;
+    if (b->short_pending) {
+        b->short_pending = false;
+        emit(b, BUTTON_EVT_DOUBLE, b->debounce_due);
+    } else if (b->cfg.double_ms == 0) {
+        emit(b, BUTTON_EVT_SHORT, b->debounce_due);
+    } else {
+        b->short_pending = true;
+        b->release_due = b->debounce_due;
+        start_gesture(b, b->cfg.double_ms);
+    }
+}
+
+// Long-press threshold (held) or end of the double window (released)
+static void gesture_cb(void* arg)
+{
+    button_t* b = (button_t*)arg;
+    if (b->short_pending) {
+        b->short_pending = false;
+        emit(b, BUTTON_EVT_SHORT, b->release_due);   // the double window is part of what the user waits
+    }
+    if (b->pressed) {
+        b->long_fired = true;
+        emit(b, BUTTON_EVT_LONG, b->gesture_due);
+    }
+}
+
+/* ====================== Setup ====================== */
+
+esp_err_t button_init(TaskHandle_t consumer)
+{
+    s_consumer = consumer;
+    esp_err_t e = gpio_install_isr_service(0);
+    if (e == ESP_ERR_INVALID_STATE) return ESP_OK;   // already installed by someone else
+    return e;
+}
+
+esp_err_t button_add(const button_cfg_t* cfg, uint8_t* id)
+{
+    if (!cfg) return ESP_ERR_INVALID_ARG;
+    if (s_count >= BUTTON_MAX) return ESP_ERR_NO_MEM;
+
+    button_t* b = &s_btn[s_count];
+    memset(b, 0, sizeof(*b));
+    b->cfg = *cfg;
+    b->id  = s_count;
+
+    gpio_config_t io = {
+        .pin_bit_mask = (1ULL << cfg->gpio),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = cfg->active_low ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE,
+        .pull_down_en = cfg->active_low ? GPIO_PULLDOWN_DISABLE : GPIO_PULLDOWN_ENABLE,
+        .intr_type = GPIO_INTR_ANYEDGE,
+    };
+    esp_err_t e = gpio_config(&io);
+    if (e != ESP_OK) return e;
+
+    esp_timer_create_args_t targs = { .callback = debounce_cb, .arg = b, .name = "btn_debounce" };
+    e = esp_timer_create(&targs, &b->debounce);
+    if (e != ESP_OK) return e;
+    targs.callback = gesture_cb;
+    targs.name     = "btn_gesture";
+    e = esp_timer_create(&targs, &b->gesture);
+    if (e != ESP_OK) {
+        esp_timer_delete(b->debounce);
+        return e;
+    }
+
+    b->pressed = raw_pressed(b);
+    e = gpio_isr_handler_add(cfg->gpio, edge_isr, b);
+    if (e != ESP_OK) {
+        esp_timer_delete(b->debounce);
+        esp_timer_delete(b->gesture);
+        return e;
+    }
+
+    if (id) *id = b->id;
+    s_count++;
+    ESP_LOGI(TAG, "Button %u on GPIO%d", b->id, (int)cfg->gpio);
+    return ESP_OK;
+}
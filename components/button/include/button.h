@@ -0,0 +1,113 @@
+/**
+ * @file button.h
+ * @brief Interrupt-driven push buttons with timer debounce and gesture detection.
+ *
+ * Edges are caught by GPIO ISRs; debouncing and short/long/double-press
+ * recognition run on esp_timer one-shots, so an idle button costs no CPU.
+ * Recognized events go into a lock-free single-consumer queue and the
+ * consumer task is woken with a task notification.
+ *
+ * Typical usage:
+ * @code
+ * button_init(xTaskGetCurrentTaskHandle());
+ * button_cfg_t cfg = BUTTON_CFG_DEFAULT(GPIO_NUM_10);
+ * button_add(&cfg, NULL);
+ *
+ * for (;;) {
+ *     ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+ *     button_event_t ev;
+ *     while (button_get_event(&ev)) { ... }
+ * }
+ * @endcode
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef BUTTON_MAX
+#define BUTTON_MAX        8     /**< Buttons supported */
+#endif
+#ifndef BUTTON_QUEUE_LEN
+#define BUTTON_QUEUE_LEN  16    /**< Event queue depth (power of two) */
+#endif
+
+/** @brief Recognized gesture */
+typedef enum {
+    BUTTON_EVT_SHORT = 0,   /**< Press + release, no second press within the double window */
+    BUTTON_EVT_LONG,        /**< Held for long_ms (reported while still held) */
+    BUTTON_EVT_DOUBLE,      /**< Second press released within the double window */
+} button_event_type_t;
+
+/** @brief Event delivered to the consumer */
+typedef struct {
+    uint8_t             id;          /**< Index returned by button_add() */
+    button_event_type_t type;
+    int64_t             stamp_us;    /**< Scheduled expiry of the debounce (last edge + debounce_ms)
+                                          that completed the gesture, or of the long-press timer.
+                                          SHORT keeps its debounced release, so its latency
+                                          includes the double_ms wait */
+    uint32_t            latency_us;  /**< stamp_us → button_get_event(), filled on pop; includes
+                                          esp_timer dispatch delay */
+} button_event_t;
+
+/** @brief Per-button configuration */
+typedef struct {
+    gpio_num_t gpio;
+    bool       active_low;    /**< True for a button to GND with pull-up */
+    uint16_t   debounce_ms;   /**< Level must be stable this long */
+    uint16_t   long_ms;       /**< Hold time for BUTTON_EVT_LONG */
+    uint16_t   double_ms;     /**< Window for a second press; 0 = no double, SHORT on release */
+} button_cfg_t;
+
+/** @brief Defaults: active-low with internal pull-up, 20 ms debounce, 800 ms long, 250 ms double. */
+#define BUTTON_CFG_DEFAULT(pin) { \
+    .gpio = (pin), .active_low = true, .debounce_ms = 20, .long_ms = 800, .double_ms = 250 }
+
+/** @brief Dispatch statistics */
+typedef struct {
+    uint32_t events;          /**< Events popped */
+    uint32_t dropped;         /**< Events lost to a full queue */
+    uint32_t max_latency_us;  /**< Worst stamp_us → pop latency */
+    uint64_t sum_latency_us;  /**< For averaging over @c events */
+} button_stats_t;
+
+/**
+ * @brief Install the GPIO ISR service and set the consumer task.
+ *
+ * @param consumer Task notified on every event (may be NULL to poll).
+ * @return ESP_OK on success; error code otherwise.
+ */
+esp_err_t button_init(TaskHandle_t consumer);
+
+/**
+ * @brief Register a button.
+ *
+ * @param cfg     Configuration (non-NULL)
+ * @param[out] id Optional; index reported in events
+ * @return ESP_OK, ESP_ERR_NO_MEM if BUTTON_MAX is reached, or a GPIO/timer error.
+ */
+esp_err_t button_add(const button_cfg_t* cfg, uint8_t* id);
+
+/**
+ * @brief Pop the next event (single consumer, non-blocking).
+ *
+ * @param[out] ev Event with latency_us filled in
+ * @return true if an event was returned.
+ */
+bool button_get_event(button_event_t* ev);
+
+/** @brief Snapshot dispatch statistics. */
+void button_get_stats(button_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
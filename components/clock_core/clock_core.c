@@ -0,0 +1,60 @@
+#include "clock_core.h"
+#include "esp_log.h"
+
+static const char* TAG = "CLOCK_CORE";
+
+/* ====================== Seqlock writer ====================== */
+
+esp_err_t clock_snapshot_publish(clock_snapshot_t* s, const ds3231_time_t* t, int64_t stamp_us)
+{
+    if (!s || !t) return ESP_ERR_INVALID_ARG;
+
+    time_t epoch;
+    esp_err_t e = ds3231_to_epoch(t, &epoch);
+    if (e != ESP_OK) return e;
+
+    uint32_t seq = __atomic_load_n(&s->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->seq, seq + 1u, __ATOMIC_RELAXED);   // odd: readers retry
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    s->time     = *t;
+    s->epoch    = epoch;
+    s->stamp_us = stamp_us;
+
+    __atomic_store_n(&s->seq, seq + 2u, __ATOMIC_RELEASE);   // even: stable
+    return ESP_OK;
+}
+
+/* ====================== Reader helpers ====================== */
+
+bool clock_snapshot_now(const clock_snapshot_t* s, int64_t now_us, ds3231_time_t* t)
+{
+    time_t epoch;
+    int64_t stamp_us;
+    if (!t || !clock_snapshot_read(s, t, &epoch, &stamp_us)) return false;
+
+    // Round to whole seconds: edges jitter by ISR latency, not by ~1 s
+    int64_t delta_us = now_us - stamp_us;
+    if (delta_us < 500000) return true;
+    time_t elapsed = (time_t)((delta_us + 500000) / 1000000);
+    return ds3231_from_epoch(epoch + elapsed, t) == ESP_OK;
+}
+
+/* ====================== Task placement ====================== */
+
+esp_err_t clock_core_pin_task(TaskFunction_t fn, const char* name, uint32_t stack,
+                              void* arg, UBaseType_t prio, BaseType_t core,
+                              TaskHandle_t* out)
+{
+#if CONFIG_FREERTOS_UNICORE
+    core = 0;
+#else
+    if (core < 0 || core >= portNUM_PROCESSORS) core = 0;
+#endif
+    if (xTaskCreatePinnedToCore(fn, name, stack, arg, prio, out, core) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create task %s", name);
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Task %s pinned to core %d", name, (int)core);
+    return ESP_OK;
+}
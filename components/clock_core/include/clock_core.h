@@ -0,0 +1,115 @@
+/**
+ * @file clock_core.h
+ * @brief Lock-free time snapshot and core-pinned task helpers for clock apps.
+ *
+ * Timekeeping (DS3231 over I²C) runs on one core and publishes the current
+ * time into a seqlock-protected snapshot; the display task on the other core
+ * reads it without ever blocking on I²C, a mutex or a queue.
+ *
+ * Single writer, any number of readers:
+ * @code
+ * static clock_snapshot_t snap;
+ *
+ * // timekeeping task (CLOCK_CORE_TIMEKEEPING)
+ * clock_snapshot_publish(&snap, &now, edge_us);
+ *
+ * // display task (CLOCK_CORE_DISPLAY)
+ * ds3231_time_t t;
+ * if (clock_snapshot_now(&snap, esp_timer_get_time(), &t)) { ... }
+ * @endcode
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+#include "ds3231.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Core assignment (collapses to core 0 on single-core targets) */
+#ifndef CLOCK_CORE_TIMEKEEPING
+#define CLOCK_CORE_TIMEKEEPING 0
+#endif
+#ifndef CLOCK_CORE_DISPLAY
+#define CLOCK_CORE_DISPLAY     1
+#endif
+
+/** @brief Seqlock-protected time snapshot. Zero-initialize before use. */
+typedef struct {
+    volatile uint32_t seq;      /**< Even = stable, odd = write in progress, 0 = never published */
+    ds3231_time_t     time;     /**< Broken-down RTC time */
+    time_t            epoch;    /**< Same instant as wall-clock epoch seconds (see ds3231_to_epoch()) */
+    int64_t           stamp_us; /**< esp_timer time the snapshot refers to (e.g. SQW edge) */
+} clock_snapshot_t;
+
+/**
+ * @brief Publish a new time (single writer only).
+ *
+ * @param s        Snapshot
+ * @param t        Time read from the RTC (must be valid, see ds3231_to_epoch())
+ * @param stamp_us esp_timer time at which @p t was current
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if @p t is not a valid time.
+ */
+esp_err_t clock_snapshot_publish(clock_snapshot_t* s, const ds3231_time_t* t, int64_t stamp_us);
+
+/**
+ * @brief Read a consistent copy of the snapshot; retries only if it races a write.
+ *
+ * @param s        Snapshot
+ * @param[out] t        Time (may be NULL)
+ * @param[out] epoch    Epoch seconds (may be NULL)
+ * @param[out] stamp_us Reference stamp (may be NULL)
+ * @return false if nothing has been published yet.
+ */
+static inline bool clock_snapshot_read(const clock_snapshot_t* s, ds3231_time_t* t,
+                                       time_t* epoch, int64_t* stamp_us)
+{
+    uint32_t s1, s2;
+    ds3231_time_t tt;
+    time_t ep;
+    int64_t st;
+    do {
+        s1 = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1u) continue;          // writer active on the other core
+        tt = s->time;
+        ep = s->epoch;
+        st = s->stamp_us;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        s2 = __atomic_load_n(&s->seq, __ATOMIC_RELAXED);
+    } while ((s1 & 1u) || s1 != s2);
+
+    if (s1 == 0) return false;
+    if (t)        *t = tt;
+    if (epoch)    *epoch = ep;
+    if (stamp_us) *stamp_us = st;
+    return true;
+}
+
+/**
+ * @brief Current time extrapolated from the snapshot by whole seconds.
+ *
+ * @param s      Snapshot
+ * @param now_us esp_timer time to evaluate at (e.g. the SQW edge just seen)
+ * @param[out] t Extrapolated time
+ * @return false if nothing has been published yet.
+ */
+bool clock_snapshot_now(const clock_snapshot_t* s, int64_t now_us, ds3231_time_t* t);
+
+/**
+ * @brief Create a task pinned to @p core (falls back to core 0 on single-core targets).
+ *
+ * @return ESP_OK, or ESP_ERR_NO_MEM if the task could not be created.
+ */
+esp_err_t clock_core_pin_task(TaskFunction_t fn, const char* name, uint32_t stack,
+                              void* arg, UBaseType_t prio, BaseType_t core,
+                              TaskHandle_t* out);
+
+#ifdef __cplusplus
+}
+#endif
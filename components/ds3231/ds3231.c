@@ -1,24 +1,136 @@
 #include "ds3231.h"
 
-#include "freertos/FreeRTOS.h"        // pdMS_TO_TICKS
+#include <stdbool.h>
+#include <stdlib.h>                   // getenv
+#include <string.h>
+#include <sys/time.h>                 // settimeofday
+#include "freertos/FreeRTOS.h"        // pdMS_TO_TICKS, portMUX
+#include "freertos/semphr.h"
 #include "driver/gpio.h"
+#include "esp_rom_sys.h"              // esp_rom_delay_us
+#include "esp_timer.h"
 #include "esp_log.h"
 #include "esp_err.h"
+#include "nvs.h"
+#include "boot_trace.h"
+#include "ds3231_bcd.h"                // bcd_to_decimal / decimal_to_bcd
 
 #define I2C_PORT              I2C_MASTER_NUM
 static const char *TAG_I2C   = "I2C_HELPER";
 static const char *TAG_RTC   = "DS3231";
+static const char *NVS_KEY_PROV = "prov_epoch";
 
-// ---------------- BCD helpers ----------------
-static inline uint8_t bcd_to_decimal(uint8_t bcd) {
-    return (uint8_t)((bcd >> 4) * 10U + (bcd & 0x0FU));
+#define STATUS_OSF            0x80    // oscillator stopped since last cleared
+
+
+// ---------------- Calendar helpers ----------------
+// Valid for the DS3231 range 2000..2199 only (century bit), which keeps the
+// leap rule down to "divisible by 4, except 2100".
+#define EPOCH_2000        946684800LL   // 2000-01-01T00:00:00Z
+#define SECS_PER_DAY      86400U
+#define DAYS_2000_TO_2200 73049U        // 200*365 + 49 leap days
+
+// Days before the 1st of each month in a common year; [12] = days in year
+static const uint16_t s_days_before_month[13] = {
+    0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365
+};
+
+static inline bool is_leap(uint16_t year) {
+    return (year & 3U) == 0 && year != 2100U;
+}
+
+// Days from 2000-01-01 to January 1st of 'year'
+static inline uint32_t days_to_year(uint16_t year) {
+    uint32_t y = (uint32_t)year - 2000U;
+    uint32_t d = y * 365U + ((y + 3U) >> 2);   // leap years in [2000, year)
+    if (y > 100U) d--;                          // 2100 is not a leap year
+    return d;
 }
-static inline uint8_t decimal_to_bcd(uint8_t dec) {
-    return (uint8_t)(((dec / 10U) << 4) | (dec % 10U));
+
+static bool date_valid(uint16_t year, uint8_t month, uint8_t date) {
+    if (year < 2000U || year > 2199U || month < 1 || month > 12 || date < 1) return false;
+    uint8_t mdays = (uint8_t)(s_days_before_month[month] - s_days_before_month[month - 1]);
+    if (month == 2 && is_leap(year)) mdays++;
+    return date <= mdays;
+}
+
+// Caller must pass a valid date
+static inline uint32_t days_since_2000(uint16_t year, uint8_t month, uint8_t date) {
+    uint32_t d = days_to_year(year) + s_days_before_month[month - 1] + (date - 1U);
+    if (month > 2 && is_leap(year)) d++;
+    return d;
+}
+
+// 2000-01-01 was a Saturday (7 with 1=Sunday)
+static inline uint8_t dow_from_days(uint32_t days) {
+    return (uint8_t)((days + 6U) % 7U + 1U);
+}
+
+/*
+ * Standard-time part of a POSIX TZ string ("std offset[dst...]"), e.g.
+ * "CET-1CEST,..." → -3600. @p utc_minus_local is added to local time to get
+ * UTC; @p has_dst is set when a DST part follows.
+ */
+static bool tz_std_offset(const char *tz, int32_t *utc_minus_local, bool *has_dst)
+{
+    const char *p = tz;
+    if (*p == '<') {                                   // quoted name, e.g. <+0530>
+        while (*p && *p != '>') p++;
+        if (*p++ != '>') return false;
+    } else {
+        const char *name = p;
+        while ((*p >= 'A' && *p <= 'Z') || (*p >= 'a' && *p <= 'z')) p++;
+        if (p - name < 3) return false;
+    }
+
+    int32_t sign = 1;
+    if (*p == '+' || *p == '-') sign = (*p++ == '-') ? -1 : 1;
+    if (*p < '0' || *p > '9') return false;
+
+    static const int32_t unit[3] = { 3600, 60, 1 };   // hh[:mm[:ss]]
+    int32_t secs = 0;
+    for (int f = 0; f < 3; ++f) {
+        int32_t v = 0;
+        while (*p >= '0' && *p <= '9') v = v * 10 + (*p++ - '0');
+        secs += v * unit[f];
+        if (*p != ':') break;
+        p++;
+    }
+
+    *utc_minus_local = sign * secs;
+    *has_dst = *p != '\0';
+    return true;
 }
 
 // ================= I²C helper =================
-esp_err_t i2c_bus_init(void)
+// Controller bus timeout (ESP32: APB cycles at 80 MHz, 20-bit field, ~13 ms max).
+// Without it a transfer that never completes waits out the legacy driver's
+// 1 s alive interval regardless of the ticks passed in.
+#define I2C_HW_TIMEOUT_MAX    0xFFFFF
+#define I2C_HW_TIMEOUT        ((DS3231_I2C_TIMEOUT_MS * 80000 > I2C_HW_TIMEOUT_MAX) ? \
+                               I2C_HW_TIMEOUT_MAX : DS3231_I2C_TIMEOUT_MS * 80000)
+
+// Mutex wait in the driver calls; the bus lock below makes contention there rare
+#define LOCK_TICKS  ((pdMS_TO_TICKS(DS3231_I2C_LOCK_MS) > 0) ? pdMS_TO_TICKS(DS3231_I2C_LOCK_MS) : 1)
+
+// Serializes every user of the port with bus recovery, which takes the pins
+// away from the controller
+static SemaphoreHandle_t s_bus_mutex;
+
+esp_err_t i2c_bus_lock(uint32_t timeout_ms)
+{
+    if (!s_bus_mutex) return ESP_ERR_INVALID_STATE;
+    return xSemaphoreTake(s_bus_mutex, pdMS_TO_TICKS(timeout_ms)) == pdTRUE ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+void i2c_bus_unlock(void)
+{
+    if (s_bus_mutex) xSemaphoreGive(s_bus_mutex);
+}
+
+// Returns the raw install result (ESP_ERR_INVALID_STATE = already installed)
+// for i2c_bus_init to report.
+static esp_err_t i2c_bus_install(void)
 {
     i2c_config_t conf = {
         .mode = I2C_MODE_MASTER,
@@ -31,17 +143,28 @@ esp_err_t i2c_bus_init(void)
     };
 
     esp_err_t ret = i2c_param_config(I2C_PORT, &conf);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG_I2C, "i2c_param_config failed: %s", esp_err_to_name(ret));
-        return ret;
-    }
+    if (ret != ESP_OK) return ret;
+
+    esp_err_t inst = i2c_driver_install(I2C_PORT, conf.mode, 0, 0, 0);
+    if (inst != ESP_OK && inst != ESP_ERR_INVALID_STATE) return inst;
+
+    // The timeout register is reset with the driver; set it after every install
+    ret = i2c_set_timeout(I2C_PORT, I2C_HW_TIMEOUT);
+    return (ret != ESP_OK) ? ret : inst;
+}
+
+esp_err_t i2c_bus_init(void)
+{
+    int trace = BOOT_TRACE_BEGIN("i2c_bus_init");
+    if (!s_bus_mutex) s_bus_mutex = xSemaphoreCreateMutex();
+    esp_err_t ret = s_bus_mutex ? i2c_bus_install() : ESP_ERR_NO_MEM;
+    BOOT_TRACE_END(trace);
 
-    ret = i2c_driver_install(I2C_PORT, conf.mode, 0, 0, 0);
     if (ret == ESP_ERR_INVALID_STATE) {
         ESP_LOGW(TAG_I2C, "I2C driver already installed on port %d", I2C_PORT);
         return ESP_OK;
     } else if (ret != ESP_OK) {
-        ESP_LOGE(TAG_I2C, "i2c_driver_install failed: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG_I2C, "I2C init failed: %s", esp_err_to_name(ret));
         return ret;
     }
 
@@ -52,6 +175,12 @@ esp_err_t i2c_bus_init(void)
 
 void i2c_bus_scan(void)
 {
+    int trace = BOOT_TRACE_BEGIN("i2c_bus_scan");
+    if (i2c_bus_lock(I2C_MASTER_TIMEOUT_MS) != ESP_OK) {
+        ESP_LOGE(TAG_I2C, "I2C bus busy, scan skipped");
+        BOOT_TRACE_END(trace);
+        return;
+    }
     ESP_LOGI(TAG_I2C, "Scanning I2C bus on port %d...", I2C_PORT);
     for (uint8_t address = 1; address < 0x7F; address++) {
         i2c_cmd_handle_t cmd = i2c_cmd_link_create();
@@ -66,48 +195,176 @@ void i2c_bus_scan(void)
             ESP_LOGI(TAG_I2C, "Found device at 0x%02X", address);
         }
     }
+    i2c_bus_unlock();
     ESP_LOGI(TAG_I2C, "I2C scan complete.");
+    BOOT_TRACE_END(trace);
 }
 
-// ================= DS3231 driver =================
-esp_err_t ds3231_read_raw(uint8_t *buf7)
+// ================= Fault handling =================
+// With both lines checked high before each attempt, an attempt ends on
+// completion or the controller timeout (I2C_HW_TIMEOUT). The budget caps the
+// whole operation.
+#define XFER_BUDGET_US     ((int64_t)DS3231_I2C_BUDGET_MS * 1000)
+#define XFER_HW_TIMEOUT_US ((int64_t)DS3231_I2C_TIMEOUT_MS * 1000)
+#define XFER_MAX_LEN 8
+#define RECOVER_HALF_PERIOD_US 5   // ~100 kHz bit-bang
+
+static ds3231_stats_t s_stats;
+static portMUX_TYPE   s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static inline bool bus_stuck(void)
 {
-    if (!buf7) {
-        ESP_LOGE(TAG_RTC, "buf7 is NULL");
-        return ESP_ERR_INVALID_ARG;
+    return gpio_get_level(I2C_MASTER_SDA_IO) == 0 || gpio_get_level(I2C_MASTER_SCL_IO) == 0;
+}
+
+/*
+ * Free a slave stuck mid-byte holding SDA low: take the pins over as GPIO,
+ * clock SCL by hand (up to 9 pulses) until SDA is released, issue a STOP and
+ * route the pins back to the controller. The driver stays installed.
+ * Caller holds s_bus_mutex. ~100 µs; no logging (runs inside the retry loop).
+ */
+static esp_err_t i2c_bus_recover(void)
+{
+    gpio_config_t io = {
+        .pin_bit_mask = (1ULL << I2C_MASTER_SCL_IO) | (1ULL << I2C_MASTER_SDA_IO),
+        .mode = GPIO_MODE_INPUT_OUTPUT_OD,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    gpio_config(&io);
+    gpio_set_level(I2C_MASTER_SDA_IO, 1);
+    gpio_set_level(I2C_MASTER_SCL_IO, 1);
+    esp_rom_delay_us(RECOVER_HALF_PERIOD_US);
+
+    for (int i = 0; i < 9 && gpio_get_level(I2C_MASTER_SDA_IO) == 0; ++i) {
+        gpio_set_level(I2C_MASTER_SCL_IO, 0);
+        esp_rom_delay_us(RECOVER_HALF_PERIOD_US);
+        gpio_set_level(I2C_MASTER_SCL_IO, 1);
+        esp_rom_delay_us(RECOVER_HALF_PERIOD_US);
     }
 
-    esp_err_t ret;
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    // STOP: SDA rises while SCL is high
+    gpio_set_level(I2C_MASTER_SCL_IO, 0);
+    gpio_set_level(I2C_MASTER_SDA_IO, 0);
+    esp_rom_delay_us(RECOVER_HALF_PERIOD_US);
+    gpio_set_level(I2C_MASTER_SCL_IO, 1);
+    esp_rom_delay_us(RECOVER_HALF_PERIOD_US);
+    gpio_set_level(I2C_MASTER_SDA_IO, 1);
+    esp_rom_delay_us(RECOVER_HALF_PERIOD_US);
 
-    // Set register pointer to 0x00
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (DS3231_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd, DS3231_REG_TIME, true);
-    i2c_master_stop(cmd);
-    ret = i2c_master_cmd_begin(I2C_PORT, cmd, pdMS_TO_TICKS(1000));
-    i2c_cmd_link_delete(cmd);
+    esp_err_t ret = i2c_set_pin(I2C_PORT, I2C_MASTER_SDA_IO, I2C_MASTER_SCL_IO,
+                                GPIO_PULLUP_ENABLE, GPIO_PULLUP_ENABLE, I2C_MODE_MASTER);
+    if (ret == ESP_OK) ret = i2c_set_timeout(I2C_PORT, I2C_HW_TIMEOUT);
+    if (ret == ESP_OK && bus_stuck()) ret = ESP_FAIL;   // e.g. SCL held low by a slave
+    return ret;
+}
+
+/*
+ * Register read (write == false) or write with bounded retries, under the bus
+ * lock. SDA or SCL low before an attempt, or an attempt that ran into the
+ * controller timeout, triggers bus recovery first; a bus still stuck after it
+ * is never handed to the controller. A plain NACK is just retried. No retry
+ * starts once XFER_BUDGET_US has elapsed.
+ */
+static esp_err_t rtc_xfer(uint8_t reg, uint8_t *buf, size_t len, bool write)
+{
+    if (len > XFER_MAX_LEN) return ESP_ERR_INVALID_SIZE;
+
+    uint8_t frame[1 + XFER_MAX_LEN];
+    if (write) {
+        frame[0] = reg;
+        memcpy(&frame[1], buf, len);
+    }
+
+    // Waiting for another bus user is contention, not a fault: not in the latency
+    esp_err_t ret = i2c_bus_lock(DS3231_I2C_LOCK_MS);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG_RTC, "Failed to set pointer: %s", esp_err_to_name(ret));
+        portENTER_CRITICAL(&s_stats_lock);
+        if (write) s_stats.writes++; else s_stats.reads++;
+        s_stats.failures++;
+        portEXIT_CRITICAL(&s_stats_lock);
         return ret;
     }
 
-    // Read 7 bytes (0x00..0x06)
-    cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (DS3231_I2C_ADDRESS << 1) | I2C_MASTER_READ, true);
-    i2c_master_read(cmd, buf7, 6, I2C_MASTER_ACK);
-    i2c_master_read_byte(cmd, buf7 + 6, I2C_MASTER_NACK);
-    i2c_master_stop(cmd);
-    ret = i2c_master_cmd_begin(I2C_PORT, cmd, pdMS_TO_TICKS(1000));
-    i2c_cmd_link_delete(cmd);
+    int64_t t0 = esp_timer_get_time();
+    uint32_t errors = 0, recoveries = 0;
+    bool recover = false;
+
+    for (int attempt = 0; attempt <= DS3231_I2C_RETRIES; ++attempt) {
+        if (recover || bus_stuck()) {
+            if (i2c_bus_recover() != ESP_OK) {
+                ret = ESP_ERR_TIMEOUT;   // lines still low: keep the controller out of it
+                errors++;
+                break;
+            }
+            recoveries++;
+        }
+
+        int64_t ta = esp_timer_get_time();
+        ret = write
+            ? i2c_master_write_to_device(I2C_PORT, DS3231_I2C_ADDRESS, frame, len + 1, LOCK_TICKS)
+            : i2c_master_write_read_device(I2C_PORT, DS3231_I2C_ADDRESS, &reg, 1, buf, len, LOCK_TICKS);
+        if (ret == ESP_OK) break;
+
+        errors++;
+        int64_t now = esp_timer_get_time();
+        if (attempt == DS3231_I2C_RETRIES || now - t0 >= XFER_BUDGET_US) break;
+        // A timeout that returned early was a wait on the driver mutex, not the bus
+        recover = ret == ESP_ERR_TIMEOUT && now - ta >= XFER_HW_TIMEOUT_US;
+    }
+
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    i2c_bus_unlock();
+
+    portENTER_CRITICAL(&s_stats_lock);
+    if (write) s_stats.writes++; else s_stats.reads++;
+    s_stats.errors     += errors;
+    s_stats.retries    += (ret == ESP_OK) ? errors : (errors ? errors - 1 : 0);
+    s_stats.recoveries += recoveries;
+    if (ret != ESP_OK) s_stats.failures++;
+    s_stats.last_latency_us = us;
+    if (us > s_stats.max_latency_us) s_stats.max_latency_us = us;
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    if (recoveries) {
+        ESP_LOGW(TAG_I2C, "Bus recovered %lu time(s), %s after %lu us",
+                 (unsigned long)recoveries, esp_err_to_name(ret), (unsigned long)us);
+    }
+    return ret;
+}
+
+void ds3231_get_stats(ds3231_stats_t *out)
+{
+    if (!out) return;
+    portENTER_CRITICAL(&s_stats_lock);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+void ds3231_reset_stats(void)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    memset(&s_stats, 0, sizeof(s_stats));
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+// ================= DS3231 driver =================
+esp_err_t ds3231_read_raw(uint8_t *buf7)
+{
+    if (!buf7) {
+        ESP_LOGE(TAG_RTC, "buf7 is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
 
+    // Pointer write + repeated-start read of 0x00..0x06
+    esp_err_t ret = rtc_xfer(DS3231_REG_TIME, buf7, 7, false);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG_RTC, "Failed to read: %s", esp_err_to_name(ret));
         return ret;
     }
 
-    ESP_LOGI(TAG_RTC, "Read 7 bytes from DS3231");
+    ESP_LOGD(TAG_RTC, "Read 7 bytes from DS3231");
     return ESP_OK;
 }
 
@@ -122,7 +379,8 @@ esp_err_t ds3231_set_time(const ds3231_time_t *t)
     data[0] = decimal_to_bcd(t->second & 0x7F);
     data[1] = decimal_to_bcd(t->minute & 0x7F);
     data[2] = decimal_to_bcd(t->hour   & 0x3F);            // write as 24h
-    data[3] = decimal_to_bcd(t->day_of_week & 0x07);
+    uint8_t dow = ds3231_day_of_week(t->year, t->month, t->date);
+    data[3] = decimal_to_bcd((dow ? dow : t->day_of_week) & 0x07);
     data[4] = decimal_to_bcd(t->date & 0x3F);
     // month + century
     uint8_t month_bcd = decimal_to_bcd(t->month & 0x1F);
@@ -131,15 +389,7 @@ esp_err_t ds3231_set_time(const ds3231_time_t *t)
     data[5] = month_bcd;
     data[6] = decimal_to_bcd((uint8_t)(t->year - base));   // 0..99
 
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (DS3231_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd, DS3231_REG_TIME, true);
-    i2c_master_write(cmd, data, sizeof(data), true);
-    i2c_master_stop(cmd);
-
-    esp_err_t ret = i2c_master_cmd_begin(I2C_PORT, cmd, pdMS_TO_TICKS(1000));
-    i2c_cmd_link_delete(cmd);
+    esp_err_t ret = rtc_xfer(DS3231_REG_TIME, data, sizeof(data), true);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG_RTC, "Failed to set time: %s", esp_err_to_name(ret));
         return ret;
@@ -174,7 +424,6 @@ esp_err_t ds3231_get_time(ds3231_time_t *t)
         t->hour = bcd_to_decimal(hr & 0x3F);
     }
 
-    t->day_of_week = bcd_to_decimal(raw[3] & 0x07);
     t->date        = bcd_to_decimal(raw[4] & 0x3F);
 
     uint8_t month_reg = raw[5];
@@ -182,6 +431,218 @@ esp_err_t ds3231_get_time(ds3231_time_t *t)
     uint16_t century_base = (month_reg & 0x80) ? 2100U : 2000U;
     t->year = (uint16_t)bcd_to_decimal(raw[6]) + century_base;
 
-    ESP_LOGI(TAG_RTC, "Time read & converted");
+    // Derive weekday from the date; fall back to the register if the date is bogus
+    uint8_t dow = ds3231_day_of_week(t->year, t->month, t->date);
+    t->day_of_week = dow ? dow : bcd_to_decimal(raw[3] & 0x07);
+
+    ESP_LOGD(TAG_RTC, "Time read & converted");
+    return ESP_OK;
+}
+
+esp_err_t ds3231_set_sqw(ds3231_sqw_t rate)
+{
+    if (rate > DS3231_SQW_8192HZ) return ESP_ERR_INVALID_ARG;
+
+    uint8_t ctrl;
+    esp_err_t ret = rtc_xfer(DS3231_REG_CONTROL, &ctrl, 1, false);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_RTC, "Failed to read control: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ctrl &= (uint8_t)~0x1CU;                                  // RS2 | RS1 | INTCN
+    if (rate == DS3231_SQW_OFF) ctrl |= 0x04U;                // INTCN=1
+    else ctrl |= (uint8_t)((rate - DS3231_SQW_1HZ) << 3);     // RS2:RS1
+
+    ret = rtc_xfer(DS3231_REG_CONTROL, &ctrl, 1, true);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_RTC, "Failed to write control: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+// ================= Calendar / epoch =================
+uint8_t ds3231_day_of_week(uint16_t year, uint8_t month, uint8_t date)
+{
+    if (!date_valid(year, month, date)) return 0;
+    return dow_from_days(days_since_2000(year, month, date));
+}
+
+esp_err_t ds3231_to_epoch(const ds3231_time_t *t, time_t *epoch)
+{
+    if (!t || !epoch) return ESP_ERR_INVALID_ARG;
+    if (t->second > 59 || t->minute > 59 || t->hour > 23 ||
+        !date_valid(t->year, t->month, t->date)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t days = days_since_2000(t->year, t->month, t->date);
+    uint32_t sod  = (uint32_t)t->hour * 3600U + (uint32_t)t->minute * 60U + t->second;
+    *epoch = (time_t)(EPOCH_2000 + (int64_t)days * SECS_PER_DAY + sod);
     return ESP_OK;
 }
+
+esp_err_t ds3231_from_epoch(time_t epoch, ds3231_time_t *t)
+{
+    if (!t) return ESP_ERR_INVALID_ARG;
+    int64_t rel = (int64_t)epoch - EPOCH_2000;
+    if (rel < 0 || rel >= (int64_t)DAYS_2000_TO_2200 * SECS_PER_DAY) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // One 64-bit divide; everything after is 32-bit
+    uint32_t days = (uint32_t)(rel / SECS_PER_DAY);
+    uint32_t sod  = (uint32_t)(rel - (int64_t)days * SECS_PER_DAY);
+
+    t->hour   = (uint8_t)(sod / 3600U);
+    sod      -= (uint32_t)t->hour * 3600U;
+    t->minute = (uint8_t)(sod / 60U);
+    t->second = (uint8_t)(sod - (uint32_t)t->minute * 60U);
+    t->day_of_week = dow_from_days(days);
+
+    // days/365 overshoots the true year by at most one
+    uint16_t year = (uint16_t)(2000U + days / 365U);
+    if (days_to_year(year) > days) year--;
+    uint32_t doy  = days - days_to_year(year);
+    bool leap     = is_leap(year);
+
+    uint8_t month = 12;
+    while (doy < (uint32_t)s_days_before_month[month - 1] + ((leap && month > 2) ? 1U : 0U)) {
+        month--;
+    }
+    doy -= s_days_before_month[month - 1] + ((leap && month > 2) ? 1U : 0U);
+
+    t->year  = year;
+    t->month = month;
+    t->date  = (uint8_t)(doy + 1U);
+    return ESP_OK;
+}
+
+esp_err_t ds3231_sync_system_time(time_t *epoch)
+{
+    ds3231_time_t t;
+    esp_err_t ret = ds3231_get_time(&t);
+    if (ret != ESP_OK) return ret;
+
+    time_t e;
+    ret = ds3231_to_epoch(&t, &e);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_RTC, "RTC holds invalid time, system clock not set");
+        return ret;
+    }
+
+    // RTC holds local time: shift the table-driven epoch by the zone offset
+    int32_t offset;
+    bool dst;
+    if (!tz_std_offset(DS3231_TZ, &offset, &dst)) {
+        ESP_LOGE(TAG_RTC, "Unparsable DS3231_TZ \"%s\"", DS3231_TZ);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (dst) {
+        // DST rules: only mktime() knows them, and only under the app's own TZ
+        const char *tz = getenv("TZ");
+        struct tm tm = {
+            .tm_sec  = t.second,
+            .tm_min  = t.minute,
+            .tm_hour = t.hour,
+            .tm_mday = t.date,
+            .tm_mon  = t.month - 1,
+            .tm_year = t.year - 1900,
+            .tm_isdst = -1,
+        };
+        time_t m = (tz && strcmp(tz, DS3231_TZ) == 0) ? mktime(&tm) : (time_t)-1;
+        if (m != (time_t)-1) {
+            e = m;
+        } else {
+            ESP_LOGW(TAG_RTC, "TZ is not DS3231_TZ, DST ignored");
+            e += offset;
+        }
+    } else {
+        e += offset;
+    }
+
+    struct timeval tv = { .tv_sec = e, .tv_usec = 0 };
+    if (settimeofday(&tv, NULL) != 0) {
+        ESP_LOGE(TAG_RTC, "settimeofday failed");
+        return ESP_FAIL;
+    }
+    if (epoch) *epoch = e;
+
+    ESP_LOGI(TAG_RTC, "System time synced from RTC (epoch %lld)", (long long)e);
+    return ESP_OK;
+}
+
+// ================= Provisioning =================
+esp_err_t ds3231_provision(const ds3231_time_t *ref, bool *written)
+{
+    if (written) *written = false;
+
+    time_t ref_epoch;
+    esp_err_t ret = ds3231_to_epoch(ref, &ref_epoch);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_RTC, "Invalid reference time");
+        return ret;
+    }
+
+    nvs_handle_t nvs;
+    ret = nvs_open(DS3231_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_RTC, "nvs_open failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    int64_t marker = 0;
+    bool marked = nvs_get_i64(nvs, NVS_KEY_PROV, &marker) == ESP_OK && marker == (int64_t)ref_epoch;
+
+    // One register read: OSF tells whether the RTC lost power since it was set
+    uint8_t status = 0;
+    ret = rtc_xfer(DS3231_REG_STATUS, &status, 1, false);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_RTC, "Failed to read status: %s", esp_err_to_name(ret));
+        nvs_close(nvs);
+        return ret;
+    }
+    bool osf = (status & STATUS_OSF) != 0;
+
+    // Fast path: this build already provisioned the RTC and it kept running
+    if (marked && !osf) {
+        nvs_close(nvs);
+        return ESP_OK;
+    }
+
+    ds3231_time_t now;
+    time_t now_epoch = 0;
+    bool rtc_ok = !osf &&
+                  ds3231_get_time(&now) == ESP_OK &&
+                  ds3231_to_epoch(&now, &now_epoch) == ESP_OK &&
+                  now_epoch >= ref_epoch;
+
+    if (!rtc_ok) {
+        if (osf) ESP_LOGW(TAG_RTC, "Oscillator stopped (OSF), RTC time lost");
+        ret = ds3231_set_time(ref);
+        if (ret == ESP_OK && osf) {
+            status &= (uint8_t)~STATUS_OSF;
+            ret = rtc_xfer(DS3231_REG_STATUS, &status, 1, true);
+        }
+        if (ret != ESP_OK) {
+            nvs_close(nvs);
+            return ret;   // no marker / OSF still set: retry on next boot
+        }
+        if (written) *written = true;
+        ESP_LOGI(TAG_RTC, "RTC provisioned to %lld", (long long)ref_epoch);
+    } else {
+        ESP_LOGI(TAG_RTC, "RTC already ahead of reference, left untouched");
+    }
+
+    if (marked) {
+        nvs_close(nvs);
+        return ESP_OK;
+    }
+    ret = nvs_set_i64(nvs, NVS_KEY_PROV, (int64_t)ref_epoch);
+    if (ret == ESP_OK) ret = nvs_commit(nvs);
+    nvs_close(nvs);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_RTC, "Failed to store provisioning marker: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
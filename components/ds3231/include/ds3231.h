@@ -2,6 +2,8 @@
 #define DS3231_H
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
 #include "esp_err.h"
 #include "driver/i2c.h"
 
@@ -31,12 +33,41 @@ extern "C" {
 #ifndef DS3231_REG_TIME
 #define DS3231_REG_TIME        0x00
 #endif
+#ifndef DS3231_REG_CONTROL
+#define DS3231_REG_CONTROL     0x0E
+#endif
+#ifndef DS3231_REG_STATUS
+#define DS3231_REG_STATUS      0x0F    // bit7 = OSF (oscillator stopped)
+#endif
+#ifndef DS3231_I2C_TIMEOUT_MS
+#define DS3231_I2C_TIMEOUT_MS  5       // controller bus timeout per attempt (ESP32: max ~13)
+#endif
+#ifndef DS3231_I2C_RETRIES
+#define DS3231_I2C_RETRIES     2       // extra attempts after the first
+#endif
+#ifndef DS3231_I2C_BUDGET_MS
+#define DS3231_I2C_BUDGET_MS   10      // no retry starts after this much time
+#endif
+#ifndef DS3231_I2C_LOCK_MS
+#define DS3231_I2C_LOCK_MS     100     // wait for other bus users (i2c_bus_lock)
+#endif
+#ifndef DS3231_NVS_NAMESPACE
+#define DS3231_NVS_NAMESPACE   "ds3231"
+#endif
+#ifndef DS3231_TZ
+#define DS3231_TZ              "UTC0"  // POSIX TZ of the time the RTC holds, e.g. "CET-1CEST,M3.5.0,M10.5.0/3"
+#endif
 
 /**
  * @brief High-level time container for DS3231.
  *
  * - hour is returned in 24-hour format regardless of RTC mode.
- * - day_of_week: 1–7, with 1=Sunday (datasheet convention).
+ * - day_of_week: 1–7, with 1=Sunday (datasheet convention). It is derived
+ *   from the date by the driver on both read and write.
+ * - Fields hold local wall-clock time (what the clock displays and what
+ *   DS3231_BUILD_TIME_INIT captures on the build host). The epoch helpers do
+ *   plain calendar arithmetic on them; only ds3231_sync_system_time() applies
+ *   DS3231_TZ to get real UTC.
  */
 typedef struct {
     uint8_t  second;       ///< 0–59
@@ -48,6 +79,78 @@ typedef struct {
     uint16_t year;         ///< e.g. 2025
 } ds3231_time_t;
 
+/** @brief INT/SQW pin mode (control register INTCN/RS2/RS1). */
+typedef enum {
+    DS3231_SQW_OFF = 0,   ///< INTCN=1: pin used for alarm interrupts only
+    DS3231_SQW_1HZ,       ///< Falling edge aligned with the seconds update
+    DS3231_SQW_1024HZ,
+    DS3231_SQW_4096HZ,
+    DS3231_SQW_8192HZ,
+} ds3231_sqw_t;
+
+/**
+ * @brief Driver health counters (cumulative since boot or last reset).
+ *
+ * An operation is one register read/write as seen by the caller; it may take
+ * several bus attempts.
+ */
+typedef struct {
+    uint32_t reads;           ///< Read operations
+    uint32_t writes;          ///< Write operations
+    uint32_t errors;          ///< Failed bus attempts (including retried ones)
+    uint32_t retries;         ///< Attempts repeated after an error
+    uint32_t failures;        ///< Operations that failed after all retries
+    uint32_t recoveries;      ///< Successful SCL clock-outs (bus released)
+    uint32_t last_latency_us; ///< Latency of the last operation, retries and recovery
+                              ///< included, bus-lock wait excluded
+    uint32_t max_latency_us;  ///< Worst operation latency seen (same scope)
+} ds3231_stats_t;
+
+/* ---------------- Build timestamp (compile-time) ----------------
+ * __DATE__ = "Mmm dd yyyy" (day space-padded), __TIME__ = "hh:mm:ss".
+ * Everything below folds to constants; nothing is parsed at runtime.
+ * Expanded in the including translation unit, so it reflects that file's build.
+ * This is the build host's local time: set DS3231_TZ to the host's zone.
+ */
+#define DS3231__D(i)  (__DATE__[i])
+#define DS3231__T(i)  (__TIME__[i])
+#define DS3231__N(c)  ((c) - '0')
+
+#define DS3231_BUILD_YEAR   (DS3231__N(DS3231__D(7)) * 1000 + DS3231__N(DS3231__D(8)) * 100 + \
+                             DS3231__N(DS3231__D(9)) * 10   + DS3231__N(DS3231__D(10)))
+#define DS3231_BUILD_MONTH  (DS3231__D(0) == 'J' ? (DS3231__D(1) == 'a' ? 1 : (DS3231__D(2) == 'n' ? 6 : 7)) : \
+                             DS3231__D(0) == 'F' ? 2 :                                                       \
+                             DS3231__D(0) == 'M' ? (DS3231__D(2) == 'r' ? 3 : 5) :                           \
+                             DS3231__D(0) == 'A' ? (DS3231__D(1) == 'p' ? 4 : 8) :                           \
+                             DS3231__D(0) == 'S' ? 9 : DS3231__D(0) == 'O' ? 10 :                           \
+                             DS3231__D(0) == 'N' ? 11 : 12)
+#define DS3231_BUILD_DATE   ((DS3231__D(4) == ' ' ? 0 : DS3231__N(DS3231__D(4))) * 10 + DS3231__N(DS3231__D(5)))
+#define DS3231_BUILD_HOUR   (DS3231__N(DS3231__T(0)) * 10 + DS3231__N(DS3231__T(1)))
+#define DS3231_BUILD_MINUTE (DS3231__N(DS3231__T(3)) * 10 + DS3231__N(DS3231__T(4)))
+#define DS3231_BUILD_SECOND (DS3231__N(DS3231__T(6)) * 10 + DS3231__N(DS3231__T(7)))
+
+/** @brief Compile-time weekday, 1–7 (1=Sunday), Sakamoto's method. */
+#define DS3231__Y(y, m)     ((y) - ((m) < 3))
+#define DS3231_DOW(y, m, d) ((DS3231__Y(y, m) + DS3231__Y(y, m) / 4 - DS3231__Y(y, m) / 100 + \
+                              DS3231__Y(y, m) / 400 + "\0\3\2\5\0\3\5\1\4\6\2\4"[(m) - 1] + (d)) % 7 + 1)
+
+/**
+ * @brief Constant initializer for a ds3231_time_t holding the build time.
+ *
+ * @code
+ * static const ds3231_time_t build = DS3231_BUILD_TIME_INIT;
+ * @endcode
+ */
+#define DS3231_BUILD_TIME_INIT {                                                     \
+    .second      = DS3231_BUILD_SECOND,                                              \
+    .minute      = DS3231_BUILD_MINUTE,                                              \
+    .hour        = DS3231_BUILD_HOUR,                                                \
+    .day_of_week = DS3231_DOW(DS3231_BUILD_YEAR, DS3231_BUILD_MONTH, DS3231_BUILD_DATE), \
+    .date        = DS3231_BUILD_DATE,                                                \
+    .month       = DS3231_BUILD_MONTH,                                               \
+    .year        = DS3231_BUILD_YEAR,                                                \
+}
+
 /**
  * @brief Initialize I²C master on the configured port/pins/frequency.
  *
@@ -60,9 +163,47 @@ esp_err_t i2c_bus_init(void);
  */
 void i2c_bus_scan(void);
 
+/**
+ * @brief Take the bus for a transaction of another device on I2C_MASTER_NUM.
+ *
+ * DS3231 bus recovery takes the pins away from the controller, so every other
+ * user of the port must hold this lock around its transfers.
+ *
+ * @param timeout_ms Maximum wait.
+ * @return ESP_OK, ESP_ERR_TIMEOUT, or ESP_ERR_INVALID_STATE before i2c_bus_init().
+ */
+esp_err_t i2c_bus_lock(uint32_t timeout_ms);
+
+/** @brief Release the lock taken with i2c_bus_lock(). */
+void i2c_bus_unlock(void);
+
+/**
+ * @brief Snapshot the driver health counters.
+ *
+ * @param[out] out Filled with the current counters.
+ */
+void ds3231_get_stats(ds3231_stats_t *out);
+
+/**
+ * @brief Zero the driver health counters.
+ */
+void ds3231_reset_stats(void);
+
 /**
  * @brief Read 7 raw BCD bytes from DS3231 time registers (0x00..0x06).
  *
+ * Every DS3231 bus operation holds the bus lock (see i2c_bus_lock()) and is
+ * retried up to DS3231_I2C_RETRIES times. SDA or SCL low before an attempt,
+ * or an attempt that ran into the controller timeout, triggers bus recovery
+ * (9 SCL clocks + STOP, pins handed back to the controller, ~100 µs); a bus
+ * still stuck afterwards fails the operation without starting a transfer, so
+ * a stuck line never reaches the legacy driver's 1 s no-interrupt wait. Each
+ * attempt is cut off by the controller's bus timeout (DS3231_I2C_TIMEOUT_MS,
+ * set with i2c_set_timeout()) and no retry starts after DS3231_I2C_BUDGET_MS:
+ * under bus faults an operation returns within BUDGET + TIMEOUT + one attempt's
+ * transfer time and recovery, ~17 ms by default, and max_latency_us reports
+ * the same span. Waiting up to DS3231_I2C_LOCK_MS for another bus user comes on top.
+ *
  * @param[out] buf7 Pointer to a 7-byte buffer.
  * @return ESP_OK on success; error code otherwise.
  */
@@ -88,6 +229,89 @@ esp_err_t ds3231_get_time(ds3231_time_t *t);
  */
 esp_err_t ds3231_set_time(const ds3231_time_t *t);
 
+/**
+ * @brief Configure the INT/SQW output (open-drain, needs a pull-up).
+ *
+ * Read-modify-write of the control register; oscillator and alarm enable bits
+ * are preserved.
+ *
+ * @param rate Square-wave rate, or DS3231_SQW_OFF.
+ * @return ESP_OK on success; error code otherwise.
+ */
+esp_err_t ds3231_set_sqw(ds3231_sqw_t rate);
+
+/* ---------------- Calendar / epoch helpers (no I²C) ---------------- */
+
+/**
+ * @brief Day of week for a calendar date (2000–2199).
+ *
+ * @param year  2000–2199
+ * @param month 1–12
+ * @param date  1–31
+ * @return 1–7 (1=Sunday), or 0 if the date is out of range.
+ */
+uint8_t ds3231_day_of_week(uint16_t year, uint8_t month, uint8_t date);
+
+/**
+ * @brief Convert a broken-down time to epoch seconds, taking the fields as UTC.
+ *
+ * Table-driven; does not call mktime() and ignores TZ. day_of_week is not read.
+ * For RTC (local) time the result is a wall-clock epoch, fine for arithmetic
+ * and comparisons but offset from real UTC by DS3231_TZ.
+ *
+ * @param[in]  t     Time to convert (year 2000–2199).
+ * @param[out] epoch Seconds since 1970-01-01 00:00:00.
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if a field is out of range.
+ */
+esp_err_t ds3231_to_epoch(const ds3231_time_t *t, time_t *epoch);
+
+/**
+ * @brief Inverse of ds3231_to_epoch() (fields come out as UTC of @p epoch).
+ *
+ * day_of_week is filled in.
+ *
+ * @param[in]  epoch Seconds since 1970-01-01 (2000-01-01 .. 2199-12-31).
+ * @param[out] t     Converted time.
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if @p epoch is outside the RTC range.
+ */
+esp_err_t ds3231_from_epoch(time_t epoch, ds3231_time_t *t);
+
+/**
+ * @brief Read the RTC once and seed the system clock (settimeofday).
+ *
+ * The RTC's local time is converted with the table-driven epoch helper plus
+ * the fixed offset parsed from DS3231_TZ, so time() returns real UTC. Only
+ * when DS3231_TZ has DST rules is mktime() used, and only if the application
+ * has set TZ to DS3231_TZ (the process TZ is never changed here); otherwise
+ * DST is ignored with a warning. Set TZ as well for localtime() to match the
+ * RTC. Afterwards time()/gettimeofday() run off the system timer with no I²C
+ * traffic.
+ *
+ * @param[out] epoch Optional; receives the UTC epoch that was applied.
+ * @return ESP_OK on success; error code otherwise.
+ */
+esp_err_t ds3231_sync_system_time(time_t *epoch);
+
+/**
+ * @brief Provision the RTC with a reference time, at most once per firmware build.
+ *
+ * The epoch of @p ref is kept as a marker in NVS (namespace DS3231_NVS_NAMESPACE).
+ *  - Marker matches and the status register's OSF bit is clear → return after
+ *    that single register read; no other I²C traffic, no NVS writes.
+ *  - Otherwise the RTC is read; it is written only if unreadable, invalid,
+ *    behind @p ref or OSF is set (oscillator stopped: first power-up, dead
+ *    backup battery). OSF is then cleared and the marker stored.
+ *
+ * A running RTC is therefore never rolled back by a reset or re-flash. After a
+ * power loss it restarts from @p ref, the best time known without a network.
+ * nvs_flash_init() must have been called.
+ *
+ * @param[in]  ref     Reference time, typically DS3231_BUILD_TIME_INIT.
+ * @param[out] written Optional; true if the RTC registers were written.
+ * @return ESP_OK on success; error code otherwise.
+ */
+esp_err_t ds3231_provision(const ds3231_time_t *ref, bool *written);
+
 #ifdef __cplusplus
 }
 #endif
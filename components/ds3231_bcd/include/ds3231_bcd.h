@@ -0,0 +1,10 @@
+#pragma once
+// BCD helpers, shared by the ds3231 driver and bench/ (no driver dependencies)
+#include <stdint.h>
+
+static inline uint8_t bcd_to_decimal(uint8_t bcd) {
+    return (uint8_t)((bcd >> 4) * 10U + (bcd & 0x0FU));
+}
+static inline uint8_t decimal_to_bcd(uint8_t dec) {
+    return (uint8_t)(((dec / 10U) << 4) | (dec % 10U));
+}
@@ -0,0 +1,113 @@
+/**
+ * @file keypad.h
+ * @brief Multi-key / matrix keypad scanner with bank-wide GPIO reads.
+ *
+ * Each scan reads the whole GPIO input bank in one register access (one per
+ * matrix row) and debounces every key at once with 2-bit vertical counters:
+ * a key changes state after 4 consecutive identical samples.
+ *
+ * Cost per scan:
+ *  - Direct mode: one bank read plus a handful of 64-bit logic ops, independent
+ *    of how many keys are configured.
+ *  - Matrix mode: O(rows). Per row, two gpio_set_level() calls, a
+ *    KEYPAD_SETTLE_US busy-wait, one bank read and one shift/mask per run of
+ *    consecutive column GPIOs (precomputed; columns on adjacent GPIOs cost one op).
+ *    The settle waits dominate: a 4x4 matrix spends ~8 µs per scan in them.
+ *  - Debounce: constant, whatever the mode.
+ *
+ * Key bit numbering in ::keypad_event_t:
+ *  - Direct mode (n_rows == 0): bit n = GPIO n.
+ *  - Matrix mode: bit KEYPAD_KEY(row, col) = row * 8 + col.
+ *
+ * Typical usage (4x4 matrix, 5 ms scan → 20 ms debounce):
+ * @code
+ * static const gpio_num_t rows[] = {13, 12, 14, 27};
+ * static const gpio_num_t cols[] = {26, 25, 33, 32};
+ * keypad_cfg_t cfg = { .rows = rows, .n_rows = 4, .cols = cols, .n_cols = 4, .active_low = true };
+ * keypad_t* kp = keypad_create(&cfg);
+ * keypad_start(kp, 5, on_keys, NULL);
+ * @endcode
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/gpio.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Opaque scanner handle */
+typedef struct keypad keypad_t;
+
+#ifndef KEYPAD_MAX_ROWS
+#define KEYPAD_MAX_ROWS   8
+#endif
+#ifndef KEYPAD_MAX_COLS
+#define KEYPAD_MAX_COLS   8
+#endif
+#ifndef KEYPAD_SETTLE_US
+#define KEYPAD_SETTLE_US  2     /**< Column settle time after driving a row */
+#endif
+
+/** @brief Key bit for a matrix position. */
+#define KEYPAD_KEY(row, col) ((row) * 8u + (col))
+
+/** @brief Scanner configuration */
+typedef struct {
+    const gpio_num_t* rows;   /**< Row pins (driven, open-drain); NULL in direct mode */
+    uint8_t           n_rows; /**< 0 = direct mode, 1..KEYPAD_MAX_ROWS = matrix */
+    const gpio_num_t* cols;   /**< Column pins (matrix) or key pins (direct) */
+    uint8_t           n_cols; /**< Matrix: 1..KEYPAD_MAX_COLS; direct: any number */
+    bool              active_low; /**< Keys pull to GND, internal pull-ups enabled.
+                                       Required in matrix mode (rows are open-drain, driven low) */
+} keypad_cfg_t;
+
+/** @brief Debounced change set from one scan */
+typedef struct {
+    uint64_t pressed;   /**< Keys that went down */
+    uint64_t released;  /**< Keys that went up */
+    uint64_t state;     /**< Keys currently down */
+} keypad_event_t;
+
+/** @brief Called from the esp_timer task when at least one key changed. */
+typedef void (*keypad_cb_t)(const keypad_event_t* ev, void* arg);
+
+/**
+ * @brief Configure pins and allocate a scanner.
+ * @return Handle, or NULL on invalid config / out of memory.
+ */
+keypad_t* keypad_create(const keypad_cfg_t* cfg);
+
+/**
+ * @brief Take one sample and run the debouncer.
+ *
+ * Can be called from any single task instead of keypad_start().
+ *
+ * @param kp Scanner
+ * @param[out] ev Change set (may be NULL)
+ * @return true if any key changed state.
+ */
+bool keypad_scan(keypad_t* kp, keypad_event_t* ev);
+
+/**
+ * @brief Scan periodically on an esp_timer and report changes.
+ *
+ * @param kp        Scanner
+ * @param period_ms Sample period; debounce time is 4 periods
+ * @param cb        Change callback (non-NULL)
+ * @param arg       Passed to @p cb
+ */
+esp_err_t keypad_start(keypad_t* kp, uint32_t period_ms, keypad_cb_t cb, void* arg);
+
+/** @brief Stop periodic scanning. */
+esp_err_t keypad_stop(keypad_t* kp);
+
+/** @return Debounced state bitmask (keys currently down). */
+uint64_t keypad_state(const keypad_t* kp);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,188 @@
+#include "keypad.h"
+#include <stdlib.h>
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+
+// Consecutive column GPIOs, gathered with one shift and mask
+typedef struct {
+    uint8_t src;    // bank bit of the first column in the run
+    uint8_t dst;    // its column index
+    uint8_t mask;   // (1 << run length) - 1
+} col_run_t;
+
+struct keypad {
+    keypad_cfg_t cfg;
+    gpio_num_t   rows[KEYPAD_MAX_ROWS];
+    col_run_t    runs[KEYPAD_MAX_COLS];      // column gather (matrix)
+    uint8_t      n_runs;
+    uint64_t     pin_mask;                   // input pins, bank-bit space
+    bool         high_bank;                  // any input on GPIO32+
+    // Vertical counters: one bit-slice per key
+    uint64_t     state, ct0, ct1;
+    esp_timer_handle_t timer;
+    keypad_cb_t  cb;
+    void*        cb_arg;
+};
+
+static const char* TAG = "KEYPAD";
+
+/* ====================== Bank access ====================== */
+
+// All inputs in one (or two, for GPIO32+) register reads
+static inline uint64_t read_bank(const keypad_t* kp)
+{
+    uint64_t v = REG_READ(GPIO_IN_REG);
+#ifdef GPIO_IN1_REG
+    if (kp->high_bank) v |= (uint64_t)REG_READ(GPIO_IN1_REG) << 32;
+#endif
+    return v;
+}
+
+static uint64_t sample_matrix(keypad_t* kp)
+{
+    uint64_t keys = 0;
+    for (uint8_t r = 0; r < kp->cfg.n_rows; ++r) {
+        gpio_set_level(kp->rows[r], 0);
+        esp_rom_delay_us(KEYPAD_SETTLE_US);
+        uint64_t bank = read_bank(kp);
+        gpio_set_level(kp->rows[r], 1);
+
+        bank = ~bank;   // active low (checked in keypad_create)
+        uint64_t row_bits = 0;
+        for (uint8_t i = 0; i < kp->n_runs; ++i) {
+            const col_run_t* run = &kp->runs[i];
+            row_bits |= ((bank >> run->src) & run->mask) << run->dst;
+        }
+        keys |= row_bits << (r * 8u);
+    }
+    return keys;
+}
+
+static inline uint64_t sample(keypad_t* kp)
+{
+    if (kp->cfg.n_rows) return sample_matrix(kp);
+    uint64_t bank = read_bank(kp);
+    return (kp->cfg.active_low ? ~bank : bank) & kp->pin_mask;
+}
+
+/* ====================== Debounce ====================== */
+
+bool keypad_scan(keypad_t* kp, keypad_event_t* ev)
+{
+    uint64_t raw = sample(kp);
+
+    // 2-bit vertical counter per key: reset while raw == state,
+    // count down while it differs, toggle state on the 4th sample.
+    uint64_t delta = raw ^ kp->state;
+    kp->ct0 = ~(kp->ct0 & delta);
+    kp->ct1 = kp->ct0 ^ (kp->ct1 & delta);
+    uint64_t toggle = delta & kp->ct0 & kp->ct1;
+    kp->state ^= toggle;
+
+    if (ev) {
+        ev->pressed  = toggle & kp->state;
+        ev->released = toggle & ~kp->state;
+        ev->state    = kp->state;
+    }
+    return toggle != 0;
+}
+
+static void scan_cb(void* arg)
+{
+    keypad_t* kp = (keypad_t*)arg;
+    keypad_event_t ev;
+    if (keypad_scan(kp, &ev)) kp->cb(&ev, kp->cb_arg);
+}
+
+/* ====================== Setup ====================== */
+
+keypad_t* keypad_create(const keypad_cfg_t* cfg)
+{
+    if (!cfg || !cfg->cols || cfg->n_cols == 0) return NULL;
+    if (cfg->n_rows > KEYPAD_MAX_ROWS) return NULL;
+    if (cfg->n_rows && (!cfg->rows || cfg->n_cols > KEYPAD_MAX_COLS)) return NULL;
+    if (cfg->n_rows && !cfg->active_low) {
+        // Open-drain rows can only pull low; with pull-downs no key would ever read
+        ESP_LOGE(TAG, "Matrix mode needs active_low (pull-up columns)");
+        return NULL;
+    }
+
+    keypad_t* kp = (keypad_t*)calloc(1, sizeof(*kp));
+    if (!kp) return NULL;
+    kp->cfg = *cfg;
+    kp->ct0 = kp->ct1 = ~0ULL;   // counters idle at "3"
+
+    gpio_config_t in = {
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = cfg->active_low ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE,
+        .pull_down_en = cfg->active_low ? GPIO_PULLDOWN_DISABLE : GPIO_PULLDOWN_ENABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    for (uint8_t c = 0; c < cfg->n_cols; ++c) {
+        if (cfg->cols[c] < 0 || cfg->cols[c] > 63) { free(kp); return NULL; }
+        in.pin_bit_mask |= 1ULL << cfg->cols[c];
+        if (cfg->cols[c] >= 32) kp->high_bank = true;
+        if (!cfg->n_rows) continue;
+
+        col_run_t* run = kp->n_runs ? &kp->runs[kp->n_runs - 1] : NULL;
+        uint8_t len = run ? (uint8_t)(__builtin_popcount(run->mask)) : 0;
+        if (run && cfg->cols[c] == run->src + len && c == run->dst + len) {
+            run->mask = (uint8_t)((run->mask << 1) | 1u);
+        } else {
+            kp->runs[kp->n_runs++] = (col_run_t){ .src = (uint8_t)cfg->cols[c], .dst = c, .mask = 1 };
+        }
+    }
+    kp->pin_mask = in.pin_bit_mask;
+    if (gpio_config(&in) != ESP_OK) { free(kp); return NULL; }
+
+    if (cfg->n_rows) {
+        gpio_config_t out = {
+            .mode = GPIO_MODE_INPUT_OUTPUT_OD,
+            .pull_up_en = GPIO_PULLUP_DISABLE,
+            .pull_down_en = GPIO_PULLDOWN_DISABLE,
+            .intr_type = GPIO_INTR_DISABLE,
+        };
+        for (uint8_t r = 0; r < cfg->n_rows; ++r) {
+            kp->rows[r] = cfg->rows[r];
+            out.pin_bit_mask |= 1ULL << cfg->rows[r];
+        }
+        if (gpio_config(&out) != ESP_OK) { free(kp); return NULL; }
+        for (uint8_t r = 0; r < cfg->n_rows; ++r) gpio_set_level(kp->rows[r], 1);   // released
+    }
+
+    ESP_LOGI(TAG, "%s keypad: %u x %u", cfg->n_rows ? "Matrix" : "Direct",
+             cfg->n_rows ? cfg->n_rows : 1, cfg->n_cols);
+    return kp;
+}
+
+esp_err_t keypad_start(keypad_t* kp, uint32_t period_ms, keypad_cb_t cb, void* arg)
+{
+    if (!kp || !cb || period_ms == 0) return ESP_ERR_INVALID_ARG;
+    if (kp->timer) return ESP_ERR_INVALID_STATE;
+
+    kp->cb     = cb;
+    kp->cb_arg = arg;
+    esp_timer_create_args_t targs = { .callback = scan_cb, .arg = kp, .name = "keypad" };
+    esp_err_t e = esp_timer_create(&targs, &kp->timer);
+    if (e != ESP_OK) return e;
+    e = esp_timer_start_periodic(kp->timer, (uint64_t)period_ms * 1000u);
+    if (e != ESP_OK) {
+        esp_timer_delete(kp->timer);
+        kp->timer = NULL;
+    }
+    return e;
+}
+
+esp_err_t keypad_stop(keypad_t* kp)
+{
+    if (!kp || !kp->timer) return ESP_ERR_INVALID_STATE;
+    esp_timer_stop(kp->timer);
+    esp_timer_delete(kp->timer);
+    kp->timer = NULL;
+    return ESP_OK;
+}
+
+uint64_t keypad_state(const keypad_t* kp) { return kp->state; }
@@ -42,6 +42,12 @@ typedef struct max7219_handle max7219_t;
 #define MAX7219_BLANK 0xFF
 #endif
 
+/**
+ * @brief Optional observer for every frame sent (e.g. max7219_emu_log_hook for
+ * replay in the chain emulator). Called from the transmitting task.
+ */
+typedef void (*max7219_tx_hook_t)(const uint8_t* tx, size_t len, void* arg);
+
 /** @brief SPI and chain configuration */
 typedef struct {
     spi_host_device_t spi_host; /**< ESP32 SPI host, e.g. SPI2_HOST */
@@ -50,6 +56,8 @@ typedef struct {
     int pin_cs;                 /**< GPIO for CS/LOAD */
     int clock_hz;               /**< SPI clock speed in Hz (e.g., 1 MHz) */
     uint8_t chain_len;          /**< Number of MAX7219 devices daisy-chained (1..8) */
+    max7219_tx_hook_t tx_hook;  /**< Optional; NULL = no capture */
+    void* tx_hook_arg;          /**< Passed to @c tx_hook */
 } max7219_bus_cfg_t;
 
 /**
@@ -102,6 +110,10 @@ esp_err_t max7219_set_scan_limit(max7219_t* h, uint8_t last_digit);
 
 /**
  * @brief Enter/exit shutdown (low-power).
+ *
+ * Digit and control registers are retained in shutdown, so a display can be
+ * blanked for long periods and restored with a single broadcast frame.
+ *
  * @param h  Driver handle
  * @param on True = normal operation, False = shutdown
  */
@@ -1,5 +1,7 @@
 #include "max7219.h"
 #include "esp_log.h"
+#include "boot_trace.h"
+#include "max7219_frame.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -32,19 +34,25 @@ struct max7219_handle {
     uint8_t chain_len;
     uint8_t active_digits; // 1..8
     uint8_t decode_mask;   // bit per digit (1 = decode ON)
+    max7219_tx_hook_t tx_hook;
+    void* tx_hook_arg;
 };
 
 static const char* TAG = "MAX7219";
 
 /* ====================== SPI helpers ====================== */
+// Frames are 2*chain_len bytes: polling avoids the interrupt + context switch
+// round trip, which dominates at this size and keeps light-sleep wakes short.
 
 static esp_err_t tx_all(max7219_t* h, uint8_t reg, uint8_t data) {
     const int n = h->chain_len;
     if (n == 0 || n > MAX_CHAIN) return ESP_ERR_INVALID_SIZE;
     uint8_t tx[2 * MAX_CHAIN];   // two bytes per device
-    for (int i = 0; i < n; ++i) { tx[2*i] = reg; tx[2*i+1] = data; }
+    max7219_frame_all(tx, n, reg, data);
     spi_transaction_t t = { .length = 16 * n, .tx_buffer = tx };
-    return spi_device_transmit(h->dev, &t);
+    esp_err_t e = spi_device_polling_transmit(h->dev, &t);
+    if (e == ESP_OK && h->tx_hook) h->tx_hook(tx, 2 * n, h->tx_hook_arg);
+    return e;
 }
 
 static esp_err_t tx_one(max7219_t* h, uint8_t dev_idx, uint8_t reg, uint8_t data) {
@@ -52,12 +60,11 @@ static esp_err_t tx_one(max7219_t* h, uint8_t dev_idx, uint8_t reg, uint8_t data
     if (dev_idx >= n) return ESP_ERR_INVALID_ARG;
     if (n == 0 || n > MAX_CHAIN) return ESP_ERR_INVALID_SIZE;
     uint8_t tx[2 * MAX_CHAIN];
-    for (int i = 0; i < n; ++i) {
-        tx[2*i]   = (i == dev_idx) ? reg  : REG_NOOP;
-        tx[2*i+1] = (i == dev_idx) ? data : 0x00;
-    }
+    max7219_frame_one(tx, n, dev_idx, reg, data);
     spi_transaction_t t = { .length = 16 * n, .tx_buffer = tx };
-    return spi_device_transmit(h->dev, &t);
+    esp_err_t e = spi_device_polling_transmit(h->dev, &t);
+    if (e == ESP_OK && h->tx_hook) h->tx_hook(tx, 2 * n, h->tx_hook_arg);
+    return e;
 }
 
 /* ====================== Init & config ====================== */
@@ -68,6 +75,7 @@ max7219_t* max7219_init(const max7219_bus_cfg_t* bus,
     if (!bus || bus->chain_len == 0 || bus->chain_len > MAX_CHAIN) return NULL;
     if (active_digits < 1 || active_digits > 8) return NULL;
 
+    int trace = BOOT_TRACE_BEGIN("max7219_spi");
     spi_bus_config_t bcfg = {
         .mosi_io_num = bus->pin_mosi,
         .miso_io_num = -1,
@@ -75,7 +83,10 @@ max7219_t* max7219_init(const max7219_bus_cfg_t* bus,
         .quadwp_io_num = -1,
         .quadhd_io_num = -1,
     };
-    if (spi_bus_initialize(bus->spi_host, &bcfg, SPI_DMA_DISABLED) != ESP_OK) return NULL;
+    if (spi_bus_initialize(bus->spi_host, &bcfg, SPI_DMA_DISABLED) != ESP_OK) {
+        BOOT_TRACE_END(trace);
+        return NULL;
+    }
 
     spi_device_interface_config_t dcfg = {
         .clock_speed_hz = bus->clock_hz,
@@ -85,18 +96,23 @@ max7219_t* max7219_init(const max7219_bus_cfg_t* bus,
     };
 
     max7219_t* h = (max7219_t*)calloc(1, sizeof(*h));
-    if (!h) { spi_bus_free(bus->spi_host); return NULL; }
+    if (!h) { spi_bus_free(bus->spi_host); BOOT_TRACE_END(trace); return NULL; }
 
     if (spi_bus_add_device(bus->spi_host, &dcfg, &h->dev) != ESP_OK) {
         spi_bus_free(bus->spi_host);
         free(h);
+        BOOT_TRACE_END(trace);
         return NULL;
     }
+    BOOT_TRACE_END(trace);
 
     h->chain_len     = bus->chain_len;
     h->active_digits = active_digits;
+    h->tx_hook       = bus->tx_hook;
+    h->tx_hook_arg   = bus->tx_hook_arg;
 
     // Bring-up: configure while in shutdown (no flicker), then enable
+    trace = BOOT_TRACE_BEGIN("max7219_config");
     (void)tx_all(h, REG_SHUTDOWN, 0x00);
     uint8_t dmask = decode_bcd ? (uint8_t)((1u << active_digits) - 1u) : 0x00;
     (void)tx_all(h, REG_DECODE_MODE, dmask);
@@ -106,13 +122,16 @@ max7219_t* max7219_init(const max7219_bus_cfg_t* bus,
     (void)tx_all(h, REG_INTENSITY,   (uint8_t)(intensity & 0x0F));
     (void)tx_all(h, REG_DISPLAYTEST, 0x00);
     (void)tx_all(h, REG_SHUTDOWN,    0x01);
+    BOOT_TRACE_END(trace);
 
     // Clear only the visible digits with the correct blank per mode
+    trace = BOOT_TRACE_BEGIN("max7219_clear");
     for (uint8_t d = 0; d < active_digits; ++d) {
         bool decode_on = ((h->decode_mask >> d) & 1u) != 0;
         uint8_t blank  = decode_on ? CODEB_BLANK : 0x00;
         (void)tx_all(h, (uint8_t)(REG_DIGIT0 + d), blank);
     }
+    BOOT_TRACE_END(trace);
 
     return h;
 }
@@ -186,11 +205,7 @@ esp_err_t max7219_set_number(max7219_t* h, uint8_t dev,
     uint8_t buf[8] = {0};
 
     // Extract digits LSB → MSB into buf[0..digits-1]
-    uint32_t tmp = value;
-    for (uint8_t i = 0; i < digits; ++i) {
-        buf[i] = (uint8_t)(tmp % 10u);
-        tmp   /= 10u;
-    }
+    max7219_split_digits(value, digits, buf);
 
     // Find most significant non-zero index (MSNZ); if value==0, MSNZ = 0
     int8_t msnz = (int8_t)digits - 1;
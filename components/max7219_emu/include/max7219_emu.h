@@ -0,0 +1,123 @@
+/**
+ * @file max7219_emu.h
+ * @brief Emulator for a MAX7219 daisy chain, driven by captured SPI frames.
+ *
+ * Models what the hardware does with the driver's byte stream: bytes shift
+ * through the chain's 16-bit shift registers (NOOP slots pass through), and
+ * on the CS rising edge every device latches the word it holds. Each device
+ * keeps its register file (digits, decode mode, intensity, scan limit,
+ * shutdown, display test) and can be rendered as 7-segment text or an 8×8
+ * bitmap. Register writes that do not change the value are counted as
+ * redundant so wasted bus time can be measured on real application traces.
+ *
+ * Capture on the device, replay on the host:
+ * @code
+ * // device: print every frame as "MAX7219_TX <hex>"
+ * max7219_bus_cfg_t bus = { ..., .tx_hook = max7219_emu_log_hook };
+ *
+ * // host (max7219-emulator app, linux target)
+ * max7219_emu_t emu;
+ * max7219_emu_init(&emu, 1, 1000000);
+ * while (fgets(line, sizeof line, stdin)) {
+ *     if (max7219_emu_feed_line(&emu, line) > 0) { max7219_emu_render(&emu, 0, buf, sizeof buf); ... }
+ * }
+ * @endcode
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MAX7219_EMU_MAX_CHAIN
+#define MAX7219_EMU_MAX_CHAIN 8
+#endif
+
+/** @brief Trace line prefix written by max7219_emu_log_hook(). */
+#define MAX7219_EMU_TRACE_PREFIX "MAX7219_TX "
+
+/** @brief One emulated device. Index 0 = farthest from the MCU (driver order). */
+typedef struct {
+    uint8_t  reg[16];   /**< Register file by address (0x1..0x8 digits, 0x9.. control) */
+    uint16_t known;     /**< Bit per register: written at least once since power-up */
+} max7219_emu_dev_t;
+
+/** @brief Traffic statistics */
+typedef struct {
+    uint32_t frames;          /**< CS frames latched */
+    uint32_t bytes;           /**< Bytes shifted */
+    uint32_t writes;          /**< Non-NOOP register writes latched (all devices) */
+    uint32_t noops;           /**< NOOP slots latched */
+    uint32_t redundant;       /**< Writes that left the register value unchanged */
+    uint32_t wasted_frames;   /**< Frames in which every write was redundant */
+    uint64_t wasted_bits;     /**< Bits shifted in wasted frames */
+    uint32_t redundant_by_reg[16]; /**< Redundant writes per register address */
+} max7219_emu_stats_t;
+
+/** @brief Emulator state. */
+typedef struct {
+    uint8_t  chain_len;
+    uint32_t clock_hz;                          /**< For bus-time figures */
+    uint8_t  sr[2 * MAX7219_EMU_MAX_CHAIN];     /**< Chain shift register, [0] = farthest */
+    uint32_t shifted;                           /**< Bytes shifted since the last latch */
+    max7219_emu_dev_t   dev[MAX7219_EMU_MAX_CHAIN];
+    max7219_emu_stats_t stats;
+} max7219_emu_t;
+
+/**
+ * @brief Reset to power-up state (shutdown, test off, other registers unknown).
+ * @param e         Emulator
+ * @param chain_len Devices in the chain (1..MAX7219_EMU_MAX_CHAIN)
+ * @param clock_hz  SPI clock used for bus-time reporting
+ */
+void max7219_emu_init(max7219_emu_t* e, uint8_t chain_len, uint32_t clock_hz);
+
+/** @brief Shift one byte into the chain (MSB first, nearest device first). */
+void max7219_emu_shift(max7219_emu_t* e, uint8_t byte);
+
+/**
+ * @brief CS rising edge: every device latches its shift-register word.
+ * @return true if what a device shows changed: its render or, while lit, its
+ *         intensity. Writes during shutdown or display test, or to digits
+ *         beyond the scan limit, change registers but return false.
+ */
+bool max7219_emu_latch(max7219_emu_t* e);
+
+/** @brief Shift @p len bytes and latch, i.e. one SPI transaction. */
+bool max7219_emu_frame(max7219_emu_t* e, const uint8_t* tx, size_t len);
+
+/**
+ * @brief Parse one trace line ("... MAX7219_TX 0C000C00") and apply the frame.
+ * @return -1 if the line holds no frame, 1 if the display visibly changed
+ *         (see max7219_emu_latch()), 0 otherwise.
+ */
+int max7219_emu_feed_line(max7219_emu_t* e, const char* line);
+
+/**
+ * @brief Render one device as text.
+ *
+ * Decode mode on any digit → one line, DIG(scan limit)..DIG0 left to right,
+ * Code-B glyphs, '.' for DP, '?' for raw digits. Decode mode off → 8 lines,
+ * '#' = lit, '.' = off, bit7 leftmost.
+ *
+ * @return Characters written (excluding NUL).
+ */
+size_t max7219_emu_render(const max7219_emu_t* e, uint8_t dev, char* out, size_t size);
+
+/** @brief Print a stats summary (including bus time at clock_hz) to stdout. */
+void max7219_emu_print_stats(const max7219_emu_t* e);
+
+/**
+ * @brief Driver TX hook that prints frames as trace lines.
+ *
+ * Signature matches max7219_tx_hook_t; @p arg is unused.
+ */
+void max7219_emu_log_hook(const uint8_t* tx, size_t len, void* arg);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,212 @@
+#include "max7219_emu.h"
+#include <stdio.h>
+#include <string.h>
+
+#define REG_NOOP        0x00
+#define REG_DIGIT0      0x01
+#define REG_DIGIT7      0x08
+#define REG_DECODE_MODE 0x09
+#define REG_INTENSITY   0x0A
+#define REG_SCAN_LIMIT  0x0B
+#define REG_SHUTDOWN    0x0C
+#define REG_DISPLAYTEST 0x0F
+
+#define DP_BIT 0x80
+
+// Largest render: 8 bitmap rows of 9 chars, intensity tag, NUL
+#define VIEW_MAX        (8 * 9 + 2)
+
+// Registers that exist; 0x0D/0x0E are ignored by the chip
+#define REG_VALID_MASK  ((uint16_t)(0x1FFEu | (1u << REG_DISPLAYTEST)))
+// Control registers are reset at power-up, digit registers are undefined
+#define REG_RESET_MASK  ((uint16_t)((1u << REG_DECODE_MODE) | (1u << REG_INTENSITY) | \
+                                    (1u << REG_SCAN_LIMIT) | (1u << REG_SHUTDOWN) |   \
+                                    (1u << REG_DISPLAYTEST)))
+
+static const char CODE_B[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '-', 'E', 'H', 'L', 'P', ' '
+};
+
+/* ====================== Chain model ====================== */
+
+void max7219_emu_init(max7219_emu_t* e, uint8_t chain_len, uint32_t clock_hz)
+{
+    memset(e, 0, sizeof(*e));
+    if (chain_len < 1) chain_len = 1;
+    if (chain_len > MAX7219_EMU_MAX_CHAIN) chain_len = MAX7219_EMU_MAX_CHAIN;
+    e->chain_len = chain_len;
+    e->clock_hz  = clock_hz;
+    for (uint8_t d = 0; d < chain_len; ++d) e->dev[d].known = REG_RESET_MASK;
+}
+
+void max7219_emu_shift(max7219_emu_t* e, uint8_t byte)
+{
+    // Everything moves one byte toward the far end; DOUT of each device feeds
+    // DIN of the next, so a NOOP slot simply passes through.
+    const size_t n = 2u * e->chain_len;
+    memmove(&e->sr[0], &e->sr[1], n - 1);
+    e->sr[n - 1] = byte;
+    e->shifted++;
+    e->stats.bytes++;
+}
+
+// What the device shows: its render, plus intensity while LEDs are lit
+static size_t dev_view(const max7219_emu_t* e, uint8_t d, char* out, size_t size)
+{
+    size_t w = max7219_emu_render(e, d, out, size);
+    const max7219_emu_dev_t* dev = &e->dev[d];
+    bool lit = (dev->reg[REG_SHUTDOWN] & 0x01) && !(dev->reg[REG_DISPLAYTEST] & 0x01);
+    if (lit && w + 1 < size) {
+        out[w++] = (char)('A' + (dev->reg[REG_INTENSITY] & 0x0F));
+        out[w] = '\0';
+    }
+    return w;
+}
+
+bool max7219_emu_latch(max7219_emu_t* e)
+{
+    uint32_t writes = 0, redundant = 0;
+    bool visible = false;
+    char before[VIEW_MAX], after[VIEW_MAX];
+
+    for (uint8_t d = 0; d < e->chain_len; ++d) {
+        max7219_emu_dev_t* dev = &e->dev[d];
+        uint8_t addr = e->sr[2 * d] & 0x0F;    // D15..D12 are don't-care
+        uint8_t data = e->sr[2 * d + 1];
+
+        if (addr == REG_NOOP || !((REG_VALID_MASK >> addr) & 1u)) {
+            e->stats.noops++;
+            continue;
+        }
+        writes++;
+        if (((dev->known >> addr) & 1u) && dev->reg[addr] == data) {
+            redundant++;
+            e->stats.redundant_by_reg[addr]++;
+            continue;
+        }
+        dev_view(e, d, before, sizeof(before));
+        dev->reg[addr] = data;
+        dev->known |= (uint16_t)(1u << addr);
+        dev_view(e, d, after, sizeof(after));
+        if (strcmp(before, after) != 0) visible = true;
+    }
+
+    e->stats.frames++;
+    e->stats.writes    += writes;
+    e->stats.redundant += redundant;
+    if (writes && writes == redundant) {
+        e->stats.wasted_frames++;
+        e->stats.wasted_bits += 8u * e->shifted;
+    }
+    e->shifted = 0;
+    return visible;
+}
+
+bool max7219_emu_frame(max7219_emu_t* e, const uint8_t* tx, size_t len)
+{
+    for (size_t i = 0; i < len; ++i) max7219_emu_shift(e, tx[i]);
+    return max7219_emu_latch(e);
+}
+
+static int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+int max7219_emu_feed_line(max7219_emu_t* e, const char* line)
+{
+    const char* p = strstr(line, MAX7219_EMU_TRACE_PREFIX);
+    if (!p) return -1;
+    p += strlen(MAX7219_EMU_TRACE_PREFIX);
+
+    size_t n = 0;
+    for (int hi, lo; (hi = hex_nibble(p[0])) >= 0 && (lo = hex_nibble(p[1])) >= 0; p += 2) {
+        max7219_emu_shift(e, (uint8_t)((hi << 4) | lo));
+        n++;
+    }
+    if (n == 0) return -1;
+    return max7219_emu_latch(e) ? 1 : 0;
+}
+
+/* ====================== Rendering ====================== */
+
+size_t max7219_emu_render(const max7219_emu_t* e, uint8_t dev_idx, char* out, size_t size)
+{
+    if (!out || size == 0) return 0;
+    out[0] = '\0';
+    if (dev_idx >= e->chain_len) return 0;
+
+    const max7219_emu_dev_t* dev = &e->dev[dev_idx];
+    const bool test   = dev->reg[REG_DISPLAYTEST] & 0x01;
+    const bool on     = dev->reg[REG_SHUTDOWN] & 0x01;
+    const uint8_t last = dev->reg[REG_SCAN_LIMIT] & 0x07;
+    const uint8_t decode = dev->reg[REG_DECODE_MODE];
+    size_t w = 0;
+
+#define EMIT(c) do { if (w + 1 < size) out[w++] = (c); } while (0)
+
+    if (!on && !test) {
+        const char* msg = "(shutdown)\n";
+        while (*msg) EMIT(*msg++);
+    } else if (decode) {
+        // Seven-segment line, leftmost = highest scanned digit
+        for (int d = last; d >= 0; --d) {
+            uint8_t v = dev->reg[REG_DIGIT0 + d];
+            bool known = (dev->known >> (REG_DIGIT0 + d)) & 1u;
+            if (test)                     { EMIT('8'); EMIT('.'); continue; }
+            if (!known)                   { EMIT(' '); continue; }
+            EMIT(((decode >> d) & 1u) ? CODE_B[v & 0x0F] : '?');
+            if (v & DP_BIT) EMIT('.');
+        }
+        EMIT('\n');
+    } else {
+        // 8x8 bitmap, row = digit register, bit7 leftmost
+        for (uint8_t r = 0; r <= last; ++r) {
+            uint8_t v = test ? 0xFF : dev->reg[REG_DIGIT0 + r];
+            for (int b = 7; b >= 0; --b) EMIT(((v >> b) & 1u) ? '#' : '.');
+            EMIT('\n');
+        }
+    }
+#undef EMIT
+
+    out[w] = '\0';
+    return w;
+}
+
+void max7219_emu_print_stats(const max7219_emu_t* e)
+{
+    const max7219_emu_stats_t* s = &e->stats;
+    uint64_t bits = (uint64_t)s->bytes * 8u;
+    uint64_t bus_us    = e->clock_hz ? bits * 1000000u / e->clock_hz : 0;
+    uint64_t wasted_us = e->clock_hz ? s->wasted_bits * 1000000u / e->clock_hz : 0;
+
+    printf("MAX7219_EMU_STATS {\"frames\":%lu,\"bytes\":%lu,\"writes\":%lu,\"noops\":%lu,"
+           "\"redundant\":%lu,\"wasted_frames\":%lu,\"bus_us\":%llu,\"wasted_us\":%llu,\"redundant_by_reg\":[",
+           (unsigned long)s->frames, (unsigned long)s->bytes, (unsigned long)s->writes,
+           (unsigned long)s->noops, (unsigned long)s->redundant, (unsigned long)s->wasted_frames,
+           (unsigned long long)bus_us, (unsigned long long)wasted_us);
+    for (int r = 0; r < 16; ++r) {
+        printf("%s%lu", r ? "," : "", (unsigned long)s->redundant_by_reg[r]);
+    }
+    printf("]}\n");
+}
+
+/* ====================== Capture ====================== */
+
+void max7219_emu_log_hook(const uint8_t* tx, size_t len, void* arg)
+{
+    (void)arg;
+    char line[sizeof(MAX7219_EMU_TRACE_PREFIX) + 4 * MAX7219_EMU_MAX_CHAIN + 1];
+    static const char HEX[] = "0123456789ABCDEF";
+    size_t w = strlen(MAX7219_EMU_TRACE_PREFIX);
+    memcpy(line, MAX7219_EMU_TRACE_PREFIX, w);
+    for (size_t i = 0; i < len && i < 2u * MAX7219_EMU_MAX_CHAIN; ++i) {
+        line[w++] = HEX[tx[i] >> 4];
+        line[w++] = HEX[tx[i] & 0x0F];
+    }
+    line[w] = '\0';
+    puts(line);
+}
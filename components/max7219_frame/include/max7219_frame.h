@@ -0,0 +1,29 @@
+#pragma once
+// Frame builders and digit extraction, shared by the max7219 driver and bench/
+// (no driver dependencies). tx[0..1] is shifted out first and therefore lands
+// in the device farthest from the MCU, which is driver index 0.
+#include <stdint.h>
+
+#define MAX7219_REG_NOOP 0x00
+
+/* Same register/data for every device: 2*n bytes */
+static inline void max7219_frame_all(uint8_t* tx, int n, uint8_t reg, uint8_t data) {
+    for (int i = 0; i < n; ++i) { tx[2*i] = reg; tx[2*i+1] = data; }
+}
+
+/* One device addressed, all others get NOOP (pass-through) */
+static inline void max7219_frame_one(uint8_t* tx, int n, int dev_idx, uint8_t reg, uint8_t data) {
+    for (int i = 0; i < n; ++i) {
+        tx[2*i]   = (i == dev_idx) ? reg  : MAX7219_REG_NOOP;
+        tx[2*i+1] = (i == dev_idx) ? data : 0x00;
+    }
+}
+
+/* Decimal digits of value, LSB first, into buf[0..digits-1] */
+static inline void max7219_split_digits(uint32_t value, uint8_t digits, uint8_t* buf) {
+    uint32_t tmp = value;
+    for (uint8_t i = 0; i < digits; ++i) {
+        buf[i] = (uint8_t)(tmp % 10u);
+        tmp   /= 10u;
+    }
+}
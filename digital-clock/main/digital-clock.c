@@ -1,6 +1,431 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "nvs_flash.h"
+#include "ds3231.h"
+#include "max7219.h"
+#include "clock_core.h"
+#include "boot_trace.h"
+#include "max7219_emu.h"
+
+// ---------------- Configuration ----------------
+#define CLOCK_24H          1     // 0 = 12 h mode, PM shown on the rightmost DP
+#define CLOCK_BLINK_SEP    0     // 1 = separators blink (2 extra SPI frames every second)
+#define CLOCK_STATS_PERIOD 60    // seconds between timing reports
+#define CLOCK_LOW_POWER    1     // 1 = automatic light sleep between SQW ticks
+#define CLOCK_OFF_FROM     1     // display shut down from this hour...
+#define CLOCK_OFF_UNTIL    6     // ...until this hour (equal values = always on)
+#define CLOCK_DEADLINE_US  50000 // SQW edge -> display updated
+#define CLOCK_CAL_PERIOD   10    // ticks between awake reference edges (low power)
+#define CLOCK_CAL_GUARD_MS 20    // light sleep held off this long before a reference edge
+#define CLOCK_TRACE_SPI    0     // 1 = log every MAX7219 frame for max7219-emulator
+
+#define SQW_GPIO           GPIO_NUM_4   // DS3231 INT/SQW (open-drain)
+#define SQW_TIMEOUT_MS     1100         // fall back to a read if a tick is missed
+
+#define DISP_MOSI          23
+#define DISP_SCLK          18
+#define DISP_CS            5
+#define DISP_CLOCK_HZ      (1 * 1000 * 1000)
+#define DISP_INTENSITY     2
+#define DISP_DIGITS        8            // "HH-MM-SS", pos 0 = rightmost
+
+// Code-B symbols (decode mode)
+#define CB_DASH   0x0A
+#define CB_BLANK  0x0F
+#define CB_DP     0x80
+
+static const char *TAG = "CLOCK";
+
+/** @brief Per-tick display timing, accumulated over one report period. */
+typedef struct {
+    uint32_t ticks;
+    uint32_t missed;       // SQW timeouts
+    uint32_t frames;       // SPI frames sent
+    uint64_t spi_us, cpu_us;
+    uint32_t max_spi_us, max_cpu_us;
+    uint32_t timed;        // ticks with a predicted edge to measure against
+    uint64_t exit_us;      // predicted SQW edge -> ISR (sleep exit + interrupt entry)
+    uint32_t max_exit_us;
+    uint64_t wake_us;      // predicted SQW edge -> display task running
+    uint32_t max_wake_us;
+    uint32_t deadline_misses;
+    uint64_t busy_us;      // display task active time
+    int64_t  since_us;     // start of the report period
+} clock_stats_t;
+
+static TaskHandle_t     s_rtc_task;      // timekeeping core: I2C only
+static TaskHandle_t     s_disp_task;     // display core: SPI only
+static clock_snapshot_t s_snap;          // seqlock hand-off between the two
+static max7219_t       *s_disp;
+static uint8_t          s_shown[DISP_DIGITS];   // register values currently on the display
+static bool             s_disp_off;             // MAX7219 in shutdown (night window)
+static volatile uint32_t s_edge_us;             // low 32 bits of esp_timer at the last SQW edge
+static volatile uint32_t s_anchor_us;           // an edge seen with the CPU already awake
+static volatile bool     s_anchored;
+static volatile uint32_t s_rtc_busy_us;         // rtc_task active time (single writer)
+static struct {
+    uint32_t ticks;                             // RTC reads this period
+    uint64_t sum_us;
+    uint32_t max_us;
+} s_i2c_tick;                                   // per-tick I2C time, rtc_task → report()
+static portMUX_TYPE s_i2c_tick_lock = portMUX_INITIALIZER_UNLOCKED;
+#if CLOCK_LOW_POWER
+static esp_pm_lock_handle_t s_cal_lock;         // NO_LIGHT_SLEEP around a reference edge
+static esp_timer_handle_t   s_cal_timer;
+static volatile bool        s_cal_armed;        // lock held: next edge is a reference
+#endif
+
+static void IRAM_ATTR sqw_isr(void *arg)
+{
+#if CLOCK_LOW_POWER
+    // Only level interrupts can wake light sleep: flip the level to re-arm,
+    // and treat the high->low transition as the tick.
+    if (gpio_get_level(SQW_GPIO)) {
+        gpio_set_intr_type(SQW_GPIO, GPIO_INTR_LOW_LEVEL);
+        return;
+    }
+    gpio_set_intr_type(SQW_GPIO, GPIO_INTR_HIGH_LEVEL);
+#endif
+    uint32_t now = (uint32_t)esp_timer_get_time();
+    s_edge_us = now;
+#if CLOCK_LOW_POWER
+    // Stamped after the ISR ran, so only an edge that found the CPU awake
+    // marks the true SQW phase
+    if (s_cal_armed) {
+        s_cal_armed = false;
+        s_anchor_us = now;
+        s_anchored  = true;
+        esp_pm_lock_release(s_cal_lock);
+    }
+#else
+    s_anchor_us = now;
+    s_anchored  = true;
+#endif
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_rtc_task, &woken);
+    vTaskNotifyGiveFromISR(s_disp_task, &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
+
+// Build the Code-B register image for "HH-MM-SS"
+static void format_time(const ds3231_time_t *t, uint8_t out[DISP_DIGITS])
+{
+    uint8_t hour = t->hour;
+    bool pm = false;
+#if !CLOCK_24H
+    pm   = hour >= 12;
+    hour = hour % 12;
+    if (hour == 0) hour = 12;
+#endif
+    uint8_t sep = CB_DASH;
+#if CLOCK_BLINK_SEP
+    if (t->second & 1) sep = CB_BLANK;
+#endif
+
+    out[7] = (!CLOCK_24H && hour < 10) ? CB_BLANK : (uint8_t)(hour / 10);
+    out[6] = (uint8_t)(hour % 10);
+    out[5] = sep;
+    out[4] = (uint8_t)(t->minute / 10);
+    out[3] = (uint8_t)(t->minute % 10);
+    out[2] = sep;
+    out[1] = (uint8_t)(t->second / 10);
+    out[0] = (uint8_t)((t->second % 10) | (pm ? CB_DP : 0));
+}
+
+// Send only the digit registers that differ from what is shown
+static uint32_t push_changes(const uint8_t next[DISP_DIGITS], uint32_t *spi_us)
+{
+    uint32_t frames = 0;
+    int64_t t0 = esp_timer_get_time();
+    for (uint8_t pos = 0; pos < DISP_DIGITS; ++pos) {
+        if (next[pos] == s_shown[pos]) continue;
+        if (max7219_write_raw(s_disp, 0, pos, next[pos]) == ESP_OK) {
+            s_shown[pos] = next[pos];
+            frames++;
+        }
+    }
+    *spi_us = (uint32_t)(esp_timer_get_time() - t0);
+    return frames;
+}
+
+// SQW is a steady 1 Hz: edges fall on whole seconds after the reference edge
+static inline uint32_t predicted_edge(uint32_t edge_us)
+{
+    uint32_t anchor = s_anchor_us;
+    uint32_t periods = (edge_us - anchor + 500000u) / 1000000u;
+    return anchor + periods * 1000000u;
+}
+
+#if CLOCK_LOW_POWER
+static void cal_timer_cb(void *arg)
+{
+    esp_pm_lock_acquire(s_cal_lock);
+    s_cal_armed = true;
+}
+
+// Keep the CPU awake across the edge due @p in_us from now
+static void schedule_reference_edge(uint32_t in_us)
+{
+    if (!s_cal_lock || s_cal_armed) return;
+    uint32_t guard = CLOCK_CAL_GUARD_MS * 1000u;
+    if (in_us <= guard) {
+        cal_timer_cb(NULL);
+    } else {
+        esp_timer_start_once(s_cal_timer, in_us - guard);
+    }
+}
+#endif
+
+static inline bool in_off_window(uint8_t hour)
+{
+    if (CLOCK_OFF_FROM == CLOCK_OFF_UNTIL) return false;
+    if (CLOCK_OFF_FROM < CLOCK_OFF_UNTIL) return hour >= CLOCK_OFF_FROM && hour < CLOCK_OFF_UNTIL;
+    return hour >= CLOCK_OFF_FROM || hour < CLOCK_OFF_UNTIL;   // window spans midnight
+}
+
+static void report(clock_stats_t *st)
+{
+    uint32_t n = st->ticks ? st->ticks : 1;
+    ds3231_stats_t i2c;
+    ds3231_get_stats(&i2c);
+    portENTER_CRITICAL(&s_i2c_tick_lock);
+    uint32_t i2c_n = s_i2c_tick.ticks ? s_i2c_tick.ticks : 1;
+    uint32_t i2c_avg = (uint32_t)(s_i2c_tick.sum_us / i2c_n), i2c_max = s_i2c_tick.max_us;
+    memset(&s_i2c_tick, 0, sizeof(s_i2c_tick));
+    portEXIT_CRITICAL(&s_i2c_tick_lock);
+
+    // Busy time of both clock tasks over the period, in 0.01 %. This is CPU
+    // load, not awake time: sleep residency comes from the PM layer below.
+    static uint32_t rtc_busy_prev;
+    uint32_t rtc_busy = s_rtc_busy_us;
+    int64_t now = esp_timer_get_time();
+    uint64_t wall = (uint64_t)(now - st->since_us);
+    uint64_t busy = st->busy_us + (uint32_t)(rtc_busy - rtc_busy_prev);
+    uint32_t duty = wall ? (uint32_t)(busy * 10000u / wall) : 0;
+    rtc_busy_prev = rtc_busy;
+
+    ESP_LOGI(TAG, "ticks=%lu missed=%lu frames=%lu | avg us: spi=%lu cpu=%lu i2c=%lu | max us: spi=%lu cpu=%lu i2c=%lu | i2c op max us (since boot)=%lu",
+             (unsigned long)st->ticks, (unsigned long)st->missed, (unsigned long)st->frames,
+             (unsigned long)(st->spi_us / n), (unsigned long)(st->cpu_us / n), (unsigned long)i2c_avg,
+             (unsigned long)st->max_spi_us, (unsigned long)st->max_cpu_us, (unsigned long)i2c_max,
+             (unsigned long)i2c.max_latency_us);
+    uint32_t m = st->timed ? st->timed : 1;
+    ESP_LOGI(TAG, "from predicted edge us: isr avg=%lu max=%lu, task avg=%lu max=%lu | deadline misses=%lu | task busy=%lu.%02lu%%",
+             (unsigned long)(st->exit_us / m), (unsigned long)st->max_exit_us,
+             (unsigned long)(st->wake_us / m), (unsigned long)st->max_wake_us,
+             (unsigned long)st->deadline_misses,
+             (unsigned long)(duty / 100), (unsigned long)(duty % 100));
+#if CONFIG_PM_PROFILING
+    esp_pm_dump_locks(stdout);   // per-mode residency, light sleep included
+#endif
+    memset(st, 0, sizeof(*st));
+    st->since_us = now;
+}
+
+// Timekeeping core: read the RTC on each edge and publish it
+static void rtc_task(void *arg)
+{
+    ds3231_time_t now;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SQW_TIMEOUT_MS));
+        int64_t stamp = esp_timer_get_time();
+        esp_err_t ret = ds3231_get_time(&now);
+        uint32_t i2c_us = (uint32_t)(esp_timer_get_time() - stamp);
+        if (ret == ESP_OK) {
+            clock_snapshot_publish(&s_snap, &now, stamp);
+        }
+        portENTER_CRITICAL(&s_i2c_tick_lock);
+        s_i2c_tick.ticks++;
+        s_i2c_tick.sum_us += i2c_us;
+        if (i2c_us > s_i2c_tick.max_us) s_i2c_tick.max_us = i2c_us;
+        portEXIT_CRITICAL(&s_i2c_tick_lock);
+        s_rtc_busy_us += (uint32_t)(esp_timer_get_time() - stamp);
+    }
+}
+
+// Display core: extrapolate from the snapshot, never waits on I2C
+static void display_task(void *arg)
+{
+    clock_stats_t st = { .since_us = esp_timer_get_time() };
+    uint8_t next[DISP_DIGITS];
+    ds3231_time_t now;
+
+    for (;;) {
+        bool edge = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SQW_TIMEOUT_MS)) != 0;
+        if (!edge) st.missed++;
+
+        int64_t t0 = esp_timer_get_time();
+        uint32_t edge_us = edge ? s_edge_us : (uint32_t)t0;
+
+        // Latency against when the edge actually happened. The ISR stamp
+        // comes after sleep exit, so the reference is the predicted edge.
+        bool timed = edge && s_anchored;
+        uint32_t pred = timed ? predicted_edge(edge_us) : edge_us;
+        int32_t exit_us = (int32_t)(edge_us - pred);
+        int32_t wake_us = (int32_t)((uint32_t)t0 - pred);
+        if (exit_us < 0) exit_us = 0;    // esp_timer drift since the reference edge
+        if (wake_us < 0) wake_us = 0;
+#if CLOCK_LOW_POWER
+        if (edge && (!s_anchored || st.ticks % CLOCK_CAL_PERIOD == CLOCK_CAL_PERIOD - 1)) {
+            schedule_reference_edge(s_anchored ? pred + 1000000u - (uint32_t)t0 : 0);
+        }
+#endif
+        if (!clock_snapshot_now(&s_snap, t0, &now)) continue;
+
+        // Night window: blank via shutdown; digit registers are retained
+        bool off = in_off_window(now.hour);
+        if (off != s_disp_off && max7219_set_shutdown(s_disp, !off) == ESP_OK) {
+            s_disp_off = off;
+        }
+
+        uint32_t spi_us = 0;
+        if (!s_disp_off) {
+            format_time(&now, next);
+            st.frames += push_changes(next, &spi_us);
+        }
+
+        int64_t t1 = esp_timer_get_time();
+        uint32_t total_us = (uint32_t)(t1 - t0);
+        uint32_t cpu_us   = total_us - spi_us;
+        if ((uint32_t)t1 - pred > CLOCK_DEADLINE_US) st.deadline_misses++;
+
+        st.ticks++;
+        st.busy_us += total_us;
+        if (timed) {
+            st.timed++;
+            st.exit_us += (uint32_t)exit_us;
+            st.wake_us += (uint32_t)wake_us;
+            if ((uint32_t)exit_us > st.max_exit_us) st.max_exit_us = (uint32_t)exit_us;
+            if ((uint32_t)wake_us > st.max_wake_us) st.max_wake_us = (uint32_t)wake_us;
+        }
+        st.spi_us += spi_us;
+        st.cpu_us += cpu_us;
+        if (spi_us > st.max_spi_us) st.max_spi_us = spi_us;
+        if (cpu_us > st.max_cpu_us) st.max_cpu_us = cpu_us;
+
+        if (st.ticks >= CLOCK_STATS_PERIOD) report(&st);
+    }
+}
+
+#if CLOCK_LOW_POWER
+// Automatic light sleep whenever both cores idle; needs CONFIG_PM_ENABLE and
+// tickless idle (see sdkconfig.defaults). The I2C and SPI drivers hold a PM
+// lock only for the duration of a transfer and keep their configuration
+// across light sleep, so nothing is reinstalled on wake.
+static void power_init(void)
+{
+    esp_pm_config_t pm = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_XTAL_FREQ,
+        .light_sleep_enable = true,
+    };
+    esp_err_t err = esp_pm_configure(&pm);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Light sleep unavailable: %s", esp_err_to_name(err));
+    }
+
+    // Wake latency needs an edge timestamp taken awake; see schedule_reference_edge()
+    const esp_timer_create_args_t cal = { .callback = cal_timer_cb, .name = "clock_cal" };
+    if (esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "clock_cal", &s_cal_lock) != ESP_OK ||
+        esp_timer_create(&cal, &s_cal_timer) != ESP_OK) {
+        s_cal_lock = NULL;
+        ESP_LOGW(TAG, "Wake latency reference unavailable");
+    }
+}
+#endif
 
 void app_main(void)
 {
+    int trace = BOOT_TRACE_BEGIN("nvs_init");
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        nvs_flash_erase();
+        err = nvs_flash_init();
+    }
+    BOOT_TRACE_END(trace);
+
+    ESP_ERROR_CHECK(i2c_bus_init());
+    static const ds3231_time_t build_time = DS3231_BUILD_TIME_INIT;
+    trace = BOOT_TRACE_BEGIN("rtc_provision");
+    if (err == ESP_OK) ds3231_provision(&build_time, NULL);
+    BOOT_TRACE_END(trace);
+
+    max7219_bus_cfg_t bus = {
+        .spi_host  = SPI2_HOST,
+        .pin_mosi  = DISP_MOSI,
+        .pin_sclk  = DISP_SCLK,
+        .pin_cs    = DISP_CS,
+        .clock_hz  = DISP_CLOCK_HZ,
+        .chain_len = 1,
+#if CLOCK_TRACE_SPI
+        .tx_hook   = max7219_emu_log_hook,
+#endif
+    };
+    s_disp = max7219_init(&bus, DISP_DIGITS, DISP_INTENSITY, /*decode_bcd=*/true);
+    if (!s_disp) {
+        ESP_LOGE(TAG, "MAX7219 init failed");
+        return;
+    }
+    memset(s_shown, CB_BLANK, sizeof(s_shown));   // max7219_init blanks all digits
+
+    // First frame right away instead of waiting up to 1 s for the first SQW edge;
+    // the same read seeds the snapshot for the display task.
+    trace = BOOT_TRACE_BEGIN("first_frame");
+    ds3231_time_t now;
+    if (ds3231_get_time(&now) == ESP_OK) {
+        clock_snapshot_publish(&s_snap, &now, esp_timer_get_time());
+        uint8_t next[DISP_DIGITS];
+        uint32_t spi_us;
+        format_time(&now, next);
+        push_changes(next, &spi_us);
+    }
+    BOOT_TRACE_END(trace);
+    boot_trace_mark("first_display");
+
+    // Off the time-to-first-display path
+    trace = BOOT_TRACE_BEGIN("rtc_sync_system_time");
+    setenv("TZ", DS3231_TZ, 1);   // app owns TZ; localtime() matches the RTC
+    tzset();
+    ds3231_sync_system_time(NULL);
+    BOOT_TRACE_END(trace);
+
+#if CLOCK_LOW_POWER
+    power_init();
+#endif
+
+    if (ds3231_set_sqw(DS3231_SQW_1HZ) != ESP_OK) {
+        ESP_LOGW(TAG, "SQW setup failed, running on %d ms timeout", SQW_TIMEOUT_MS);
+    }
+
+    // boot_trace is single-task: finish it before rtc_task can reach traced code
+    boot_trace_dump();
+
+    clock_core_pin_task(rtc_task, "rtc", 3072, NULL, 6, CLOCK_CORE_TIMEKEEPING, &s_rtc_task);
+    clock_core_pin_task(display_task, "display", 3072, NULL, 5, CLOCK_CORE_DISPLAY, &s_disp_task);
 
+    // 1 Hz SQW from the RTC wakes both tasks
+    gpio_config_t sqw_conf = {
+        .pin_bit_mask = (1ULL << SQW_GPIO),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = CLOCK_LOW_POWER ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_NEGEDGE,
+    };
+    gpio_config(&sqw_conf);
+#if CLOCK_LOW_POWER
+    // Wake-up stays enabled while the ISR flips the level, so the CPU wakes on both halves
+    gpio_wakeup_enable(SQW_GPIO, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+#endif
+    gpio_install_isr_service(0);
+    gpio_isr_handler_add(SQW_GPIO, sqw_isr, NULL);
 }
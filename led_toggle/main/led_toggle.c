@@ -2,12 +2,27 @@
 #include "driver/gpio.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "button.h"
+#include "keypad.h"
 
 // Define pin 
 #define LED_GPIO    GPIO_NUM_8
 #define BUTTON_GPIO GPIO_NUM_10
+#define KEY_ON_GPIO  GPIO_NUM_4     // extra keys, direct-mode keypad bank
+#define KEY_OFF_GPIO GPIO_NUM_5
+#define KEYPAD_SCAN_MS 5            // 20 ms debounce
 
-// Initialize LED and button GPIOs
+// Keys pressed since the main task last looked (set from the esp_timer task)
+static uint64_t s_keys_pressed;
+
+static void on_keys(const keypad_event_t* ev, void* arg)
+{
+    if (!ev->pressed) return;
+    __atomic_fetch_or(&s_keys_pressed, ev->pressed, __ATOMIC_RELAXED);
+    xTaskNotifyGive((TaskHandle_t)arg);
+}
+
+// Initialize LED GPIO (the button is configured by the button component)
 void init_gpio(void){
 
     // LED as output
@@ -19,37 +34,51 @@ void init_gpio(void){
         .intr_type = GPIO_INTR_DISABLE,
     };
     gpio_config(&led_conf);
-
-
-    gpio_config_t button_conf ={
-        .pin_bit_mask = (1ULL << BUTTON_GPIO),
-        .mode = GPIO_MODE_INPUT,
-        .pull_up_en = GPIO_PULLUP_ENABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
-    };
-    gpio_config(&button_conf);
 }
 
 void app_main(void){
 
     init_gpio();
 
+    // Edge ISR + esp_timer debounce; this task sleeps until an event arrives
+    button_init(xTaskGetCurrentTaskHandle());
+    button_cfg_t button_conf = BUTTON_CFG_DEFAULT(BUTTON_GPIO);
+    button_add(&button_conf, NULL);
+
+    // Both keys share one bank read per scan
+    static const gpio_num_t keys[] = { KEY_ON_GPIO, KEY_OFF_GPIO };
+    keypad_cfg_t kp_conf = { .rows = NULL, .n_rows = 0, .cols = keys, .n_cols = 2, .active_low = true };
+    keypad_t* kp = keypad_create(&kp_conf);
+    if (kp) keypad_start(kp, KEYPAD_SCAN_MS, on_keys, xTaskGetCurrentTaskHandle());
+    else printf("Keypad init failed, keys disabled\n");
+
     int led_state = 0;
-    int last_button_state = 1;
 
     while (1) {
-        int button_state = gpio_get_level(BUTTON_GPIO);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
-        // Detect falling edge (1 -> 0)
-        if (last_button_state == 1 && button_state == 0){
-            led_state = !led_state;
-            gpio_set_level(LED_GPIO, led_state);
-            printf("Button: %d, LED: %d\n", button_state, led_state);
-            vTaskDelay(pdMS_TO_TICKS(200)); // debounce delay
+        button_event_t ev;
+        while (button_get_event(&ev)) {
+            switch (ev.type) {
+            case BUTTON_EVT_SHORT:  led_state = !led_state; break;   // toggle
+            case BUTTON_EVT_DOUBLE: led_state = 1;          break;   // force on
+            case BUTTON_EVT_LONG:   led_state = 0;          break;   // force off
             }
+            gpio_set_level(LED_GPIO, led_state);
+
+            button_stats_t st;
+            button_get_stats(&st);
+            printf("Event: %d, LED: %d, latency: %lu us (max %lu us, dropped %lu)\n",
+                   ev.type, led_state, (unsigned long)ev.latency_us,
+                   (unsigned long)st.max_latency_us, (unsigned long)st.dropped);
+        }
 
-        last_button_state = button_state;
-        vTaskDelay(pdMS_TO_TICKS(10)); // Pulling interval
+        uint64_t pressed = __atomic_exchange_n(&s_keys_pressed, 0, __ATOMIC_RELAXED);
+        if (pressed) {
+            if (pressed & (1ULL << KEY_ON_GPIO))  led_state = 1;
+            if (pressed & (1ULL << KEY_OFF_GPIO)) led_state = 0;
+            gpio_set_level(LED_GPIO, led_state);
+            printf("Keys: 0x%llx, LED: %d\n", (unsigned long long)pressed, led_state);
+        }
     }
 }
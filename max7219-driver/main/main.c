@@ -1,6 +1,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "max7219.h"
+#include "boot_trace.h"
 
 void app_main(void)
 {
@@ -17,6 +18,8 @@ void app_main(void)
 
     // Show 12.34 (DP on digit2 from right)
     max7219_set_number(h, 0, 1230, 0b0000, /*blank_zero=*/true);
+    boot_trace_mark("first_display");
+    boot_trace_dump();
     vTaskDelay(pdMS_TO_TICKS(5000));
 
     // Example: HH:MM on 4 digits, DP on colon (pos 2)
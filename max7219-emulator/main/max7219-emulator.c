@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "max7219_emu.h"
+#include "boot_trace.h"
+
+// ---------------- Configuration ----------------
+#define EMU_CLOCK_HZ   1000000   // SPI clock of the captured app (digital-clock: 1 MHz)
+#define EMU_QUIET      0         // 1 = stats only, no rendering
+
+/*
+ * Usage (linux target):
+ *   idf.py -p /dev/ttyUSB0 monitor | tee log.txt     # app built with the TX hook
+ *   ./build/max7219-emulator.elf < log.txt
+ *
+ * Every trace line is shifted through the chain and latched. When the display
+ * changes, all devices are printed as "[frame N] dev D: <render>". At EOF one
+ * MAX7219_EMU_STATS line summarises redundant writes and wasted bus time.
+ * The chain length is taken from the first frame (2 bytes per device).
+ * A BOOT_TRACE line (host clock) times the replay, as on the device.
+ */
+
+static size_t frame_bytes(const char* line)
+{
+    const char* p = strstr(line, MAX7219_EMU_TRACE_PREFIX);
+    if (!p) return 0;
+    p += strlen(MAX7219_EMU_TRACE_PREFIX);
+    size_t n = strspn(p, "0123456789abcdefABCDEF");
+    return n / 2;
+}
+
+static void print_display(const max7219_emu_t* emu)
+{
+    char buf[8 * 9 + 1];
+    for (uint8_t d = 0; d < emu->chain_len; ++d) {
+        max7219_emu_render(emu, d, buf, sizeof(buf));
+        printf("[frame %lu] dev %u:%c%s", (unsigned long)emu->stats.frames, d,
+               strchr(buf, '\n') == buf + strlen(buf) - 1 ? ' ' : '\n', buf);
+    }
+}
+
+void app_main(void)
+{
+    static max7219_emu_t emu;
+    bool ready = false;
+    char line[256];
+    bool shown = false;
+
+    int trace = BOOT_TRACE_BEGIN("emu_replay");
+    while (fgets(line, sizeof(line), stdin)) {
+        if (!ready) {
+            size_t n = frame_bytes(line);
+            if (n < 2) continue;
+            max7219_emu_init(&emu, (uint8_t)(n / 2), EMU_CLOCK_HZ);
+            ready = true;
+        }
+        if (max7219_emu_feed_line(&emu, line) > 0) {
+            if (!shown) boot_trace_mark("emu_first_display");
+            shown = true;
+            if (!EMU_QUIET) print_display(&emu);
+        }
+    }
+    BOOT_TRACE_END(trace);
+    boot_trace_dump();
+
+    if (ready) max7219_emu_print_stats(&emu);
+    else printf("No %s lines on stdin\n", MAX7219_EMU_TRACE_PREFIX);
+    exit(0);
+}